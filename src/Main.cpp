@@ -1,395 +1,183 @@
+#include <algorithm>
 #include <iostream>
 #include <vector>
-#include <chrono>
 #include <iomanip>
-#include <fstream>
 #include <cmath>
-#include <functional>
-#include <windows.h>
-#include <psapi.h>
-
-#include "data_structures/dense_matrix/DenseMatrix.h"
-#include "data_structures/sparse_matrix_hash/SparseMatrixHash.h"
-#include "data_structures/sparse_matrix_tree/SparseMatrixTree.h"
+#include <cstdlib>
+#include <sstream>
+#include <string>
+
+#include "benchmark/Calibration.h"
+#include "benchmark/Harness.h"
+#include "benchmark/Suites.h"
+#include "parallel/ThreadPool.h"
+
+// Sem MC458_DEFAULT_OPERATION o executável faz a varredura completa; os alvos por operação
+// (MC458_Bench_<Operacao>) o definem e medem só essa operação, em um tamanho pequeno por padrão
+#ifdef MC458_DEFAULT_OPERATION
+constexpr const char *DEFAULT_OPERATION = MC458_DEFAULT_OPERATION;
+#else
+constexpr const char *DEFAULT_OPERATION = nullptr;
+#endif
+
+struct CommandLine {
+  BenchmarkFilter filter;
+  std::vector<int> dimensions;
+  std::vector<double> sparsities;
+  std::string output = "resultados";
+  bool calibrate = false;
+};
 
-SIZE_T getMemoryUseKB() {
-  PROCESS_MEMORY_COUNTERS pmc;
-  GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc));
-  return pmc.WorkingSetSize / 1024;
+// Lê uma opção inteira do ambiente (MC458_WARMUPS, MC458_REPETITIONS, MC458_BUDGET_MS, MC458_PERF),
+// mantendo o padrão se ausente
+int environmentOption(const char *name, const int fallback) {
+  const char *value = std::getenv(name);
+  return value != nullptr ? std::atoi(value) : fallback;
 }
 
-SparseMatrixTree::TreeNode *generateSparseMatrixTree(const int n, const long long k_expected) {
-  SparseMatrixTree::TreeNode *root = nullptr;
-
-  for (long long count = 0; count < k_expected; count++) {
-    const int i = rand() % n;
-    const int j = rand() % n;
-    const int value = (rand() % 9) + 1;
-    root = SparseMatrixTree::insert(root, i, j, value);
+std::vector<std::string> splitList(const std::string &list) {
+  std::vector<std::string> items;
+  std::stringstream stream(list);
+  std::string item;
+  while (std::getline(stream, item, ',')) {
+    if (!item.empty()) {
+      items.push_back(item);
+    }
   }
-
-  return root;
+  return items;
 }
 
-SparseMatrixHash generateSparseMatrixHash(const int n, const long long k_expected) {
-  SparseMatrixHash M(n, n);
-
-  for (long long count = 0; count < k_expected; count++) {
-    const int i = rand() % n;
-    const int j = rand() % n;
-    const double value = (rand() % 9) + 1;
-    M.set(i, j, value);
+bool knownNames(const std::vector<std::string> &names, const std::vector<std::string> &known) {
+  for (const std::string &name: names) {
+    if (std::find(known.begin(), known.end(), name) == known.end()) {
+      std::cerr << "Nome desconhecido: " << name << "\n";
+      return false;
+    }
   }
-
-  return M;
+  return true;
 }
 
-DenseMatrix generateDenseMatrix(const int n, const long long k_expected) {
-  DenseMatrix M(n, n);
-
-  for (long long count = 0; count < k_expected; count++) {
-    const int i = rand() % n;
-    const int j = rand() % n;
-    const double value = (rand() % 9) + 1;
-    M.set(i, j, value);
+void printUsage(const char *program) {
+  std::cout << "Uso: " << program << " [opcoes]\n"
+      << "  --estrutura LISTA     estruturas separadas por virgula (Hash,Tree,BPTree,Dense)\n"
+      << "  --operacao LISTA      operacoes separadas por virgula (";
+  for (size_t op = 0; op < BENCHMARK_OPERATIONS.size(); op++) {
+    std::cout << (op > 0 ? "," : "") << BENCHMARK_OPERATIONS[op];
   }
-
-  return M;
-}
-
-struct BenchmarkResult {
-  double time_ms;
-  SIZE_T memory_kb;
-};
-
-template<typename Func>
-BenchmarkResult benchmark(Func func) {
-  const SIZE_T mem_before = getMemoryUseKB();
-  const auto start = std::chrono::high_resolution_clock::now();
-
-  func();
-
-  const auto end = std::chrono::high_resolution_clock::now();
-  const SIZE_T mem_after = getMemoryUseKB();
-
-  const double time_ms = std::chrono::duration<double, std::milli>(end - start).count();
-  const SIZE_T memory_kb = (mem_after > mem_before) ? (mem_after - mem_before) : 0;
-
-  return {time_ms, memory_kb};
+  std::cout << ")\n"
+      << "  --n LISTA             dimensoes das matrizes (padrao: 100 a 1000000)\n"
+      << "  --densidade LISTA     fracoes de nao nulos, ex. 0.01,0.05 (padrao: depende de n)\n"
+      << "  --repeticoes R        repeticoes cronometradas (MC458_REPETITIONS)\n"
+      << "  --aquecimentos W      execucoes de aquecimento (MC458_WARMUPS)\n"
+      << "  --orcamento-ms B      tempo maximo de repeticoes por operacao (MC458_BUDGET_MS)\n"
+      << "  --contadores          coleta contadores de hardware (MC458_PERF=1)\n"
+      << "  --calibrar            mede os limiares da matriz adaptativa em cada n (padrao: 1000)\n"
+      << "  --saida PREFIXO       grava PREFIXO.csv e PREFIXO.json (padrao: resultados)\n";
 }
 
-void SparseMatrixHashTest(const int n, const double sparsity, std::ofstream &csv_file, const long long k_expected) {
-  std::cout << "\n--- Estrutura 1 (E1): Hash Map ---\n";
-
-  SparseMatrixHash hash_a(n, n);
-  SparseMatrixHash hash_b(n, n);
-
-  // Geração
-  auto result = benchmark([&]() {
-    hash_a = generateSparseMatrixHash(n, k_expected);
-  });
-  std::cout << "Geracao: " << result.time_ms << " ms, Mem: " << result.memory_kb << " KB\n";
-  csv_file << "Hash,Geracao," << n << "," << (sparsity * 100) << "," << k_expected << ","
-      << result.time_ms << "," << result.memory_kb << "\n";
-
-  // Cria lista de posições existentes
-  std::vector<std::pair<int, int> > hash_existing;
-  for (auto [i, j, v]: hash_a.items()) {
-    if (hash_existing.size() < 1000) {
-      hash_existing.push_back({i, j});
-    }
+/// @brief Interpreta a linha de comando sobre os padrões do ambiente
+/// @return falso se a linha de comando é inválida ou pede ajuda
+bool parseCommandLine(const int argc, char **argv, CommandLine &command) {
+  benchmarkOptions.warmups = environmentOption("MC458_WARMUPS", benchmarkOptions.warmups);
+  benchmarkOptions.repetitions = environmentOption("MC458_REPETITIONS", benchmarkOptions.repetitions);
+  benchmarkOptions.budget_ms = environmentOption("MC458_BUDGET_MS", static_cast<int>(benchmarkOptions.budget_ms));
+  benchmarkOptions.counters = environmentOption("MC458_PERF", 0) != 0;
+
+  if (DEFAULT_OPERATION != nullptr) {
+    command.filter.operations = {DEFAULT_OPERATION};
+    command.dimensions = {1000};
+    command.sparsities = {0.01};
   }
 
-  // Acesso a elementos existentes
-  if (!hash_existing.empty()) {
-    result = benchmark([&]() {
-      for (int t = 0; t < 1000 && t < static_cast<int>(hash_existing.size()); t++) {
-        auto [i, j] = hash_existing[t];
-        hash_a.get(i, j);
-      }
-    });
-    std::cout << "Acesso Existente (1000x): " << result.time_ms << " ms\n";
-    csv_file << "Hash,AcessoExistente," << n << "," << (sparsity * 100) << "," << k_expected << ","
-        << result.time_ms << ",0\n";
-  }
-
-  // Acesso aleatório
-  result = benchmark([&]() {
-    for (int t = 0; t < 1000; t++) {
-      int i = rand() % n, j = rand() % n;
-      hash_a.get(i, j);
+  for (int a = 1; a < argc; a++) {
+    const std::string option = argv[a];
+    if (option == "--contadores") {
+      benchmarkOptions.counters = true;
+      continue;
     }
-  });
-  std::cout << "Acesso Aleatorio (1000x): " << result.time_ms << " ms\n";
-  csv_file << "Hash,AcessoAleatorio," << n << "," << (sparsity * 100) << "," << k_expected << ","
-      << result.time_ms << ",0\n";
-
-  // Inserção
-  result = benchmark([&]() {
-    for (int t = 0; t < 100; t++) {
-      int i = rand() % n, j = rand() % n;
-      double v = rand() % 9 + 1;
-      hash_a.set(i, j, v);
+    if (option == "--calibrar") {
+      command.calibrate = true;
+      continue;
     }
-  });
-  std::cout << "Insercao (100x): " << result.time_ms << " ms\n";
-  csv_file << "Hash,Insercao," << n << "," << (sparsity * 100) << "," << k_expected << ","
-      << result.time_ms << ",0\n";
-
-  // Transposta
-  result = benchmark([&]() {
-    SparseMatrixHash hash_t = hash_a.transpose();
-  });
-  std::cout << "Transposta: " << result.time_ms << " ms\n";
-  csv_file << "Hash,Transposta," << n << "," << (sparsity * 100) << "," << k_expected << ","
-      << result.time_ms << ",0\n";
-
-  // Soma
-  hash_b = generateSparseMatrixHash(n, k_expected);
-  SparseMatrixHash hash_sum(n, n);
-  result = benchmark([&]() {
-    hash_sum = hash_a.add(hash_b);
-  });
-  std::cout << "Soma: " << result.time_ms << " ms, Mem: " << result.memory_kb << " KB\n";
-  csv_file << "Hash,Soma," << n << "," << (sparsity * 100) << "," << k_expected << ","
-      << result.time_ms << "," << result.memory_kb << "\n";
-
-  // Multiplicação escalar
-  SparseMatrixHash hash_scalar(n, n);
-  result = benchmark([&]() {
-    hash_scalar = hash_a.scalarMult(5);
-  });
-  std::cout << "Mult Escalar: " << result.time_ms << " ms\n";
-  csv_file << "Hash,MultEscalar," << n << "," << (sparsity * 100) << "," << k_expected << ","
-      << result.time_ms << ",0\n";
-
-  SparseMatrixHash hash_mult(n, n);
-  result = benchmark([&]() {
-    hash_mult = hash_a.mult(hash_b);
-  });
-  std::cout << "Mult Matrizes: " << result.time_ms << " ms, Mem: "
-      << result.memory_kb << " KB\n";
-  csv_file << "Hash,MultMatrizes," << n << "," << (sparsity * 100) << "," << k_expected << ","
-      << result.time_ms << "," << result.memory_kb << "\n";
-}
-
-void SparseMatrixTreeTest(const int n, const double sparsity, std::ofstream &csv_file, const long long k_expected) {
-  std::cout << "\n--- Estrutura 2 (E2): Red-Black Tree ---\n";
-
-  SparseMatrixTree::TreeNode *tree_a = nullptr;
-  SparseMatrixTree::TreeNode *tree_b = nullptr;
-
-  // Geração
-  auto result = benchmark([&]() {
-    tree_a = generateSparseMatrixTree(n, k_expected);
-  });
-  std::cout << "Geracao: " << result.time_ms << " ms, Mem: " << result.memory_kb << " KB\n";
-  csv_file << "Tree,Geracao," << n << "," << (sparsity * 100) << "," << k_expected << ","
-      << result.time_ms << "," << result.memory_kb << "\n";
-
-  // Cria lista de posições existentes para teste de acesso
-  std::vector<std::pair<int, int> > existing_positions;
-  std::vector<SparseMatrixTree::TreeNode *> nodes;
-  SparseMatrixTree::inorderGet(tree_a, false, nodes);
-  for (auto node: nodes) {
-    if (existing_positions.size() < 1000) {
-      existing_positions.push_back({node->row, node->column});
+    if (option == "--ajuda" || option == "-h" || a + 1 >= argc) {
+      return false;
     }
-  }
 
-  // Acesso a elementos existentes (Pior Caso)
-  if (!existing_positions.empty()) {
-    result = benchmark([&]() {
-      for (int t = 0; t < 1000 && t < static_cast<int>(existing_positions.size()); t++) {
-        auto [i, j] = existing_positions[t];
-        SparseMatrixTree::findElement(tree_a, i, j, false);
+    const std::string value = argv[++a];
+    if (option == "--estrutura") {
+      command.filter.structures = splitList(value);
+    } else if (option == "--operacao") {
+      command.filter.operations = splitList(value);
+    } else if (option == "--n") {
+      command.dimensions.clear();
+      for (const std::string &item: splitList(value)) {
+        command.dimensions.push_back(std::atoi(item.c_str()));
       }
-    });
-    std::cout << "Acesso Existente (1000x): " << result.time_ms << " ms\n";
-    csv_file << "Tree,AcessoExistente," << n << "," << (sparsity * 100) << "," << k_expected << ","
-        << result.time_ms << ",0\n";
-  }
-
-  // Acesso a elementos zero (Caso Médio)
-  result = benchmark([&]() {
-    for (int t = 0; t < 1000; t++) {
-      int i = rand() % n, j = rand() % n;
-      SparseMatrixTree::findElement(tree_a, i, j, false);
-    }
-  });
-  std::cout << "Acesso Aleatorio (1000x): " << result.time_ms << " ms\n";
-  csv_file << "Tree,AcessoAleatorio," << n << "," << (sparsity * 100) << "," << k_expected << ","
-      << result.time_ms << ",0\n";
-
-  // Inserção
-  result = benchmark([&]() {
-    for (int t = 0; t < 100; t++) {
-      int i = rand() % n, j = rand() % n;
-      int val = rand() % 9 + 1;
-      tree_a = SparseMatrixTree::insert(tree_a, i, j, val);
+    } else if (option == "--densidade") {
+      command.sparsities.clear();
+      for (const std::string &item: splitList(value)) {
+        command.sparsities.push_back(std::atof(item.c_str()));
+      }
+    } else if (option == "--repeticoes") {
+      benchmarkOptions.repetitions = std::atoi(value.c_str());
+    } else if (option == "--aquecimentos") {
+      benchmarkOptions.warmups = std::atoi(value.c_str());
+    } else if (option == "--orcamento-ms") {
+      benchmarkOptions.budget_ms = std::atof(value.c_str());
+    } else if (option == "--saida") {
+      command.output = value;
+    } else {
+      return false;
     }
-  });
-  std::cout << "Insercao (100x): " << result.time_ms << " ms\n";
-  csv_file << "Tree,Insercao," << n << "," << (sparsity * 100) << "," << k_expected << ","
-      << result.time_ms << ",0\n";
-
-  // Transposta
-  result = benchmark([&]() {
-    volatile bool transpose_flag = true;
-  });
-  std::cout << "Transposta: " << result.time_ms << " ms\n";
-  csv_file << "Tree,Transposta," << n << "," << (sparsity * 100) << "," << k_expected << ","
-      << result.time_ms << ",0\n";
-
-  // Soma
-  tree_b = generateSparseMatrixTree(n, k_expected);
-  SparseMatrixTree::TreeNode *tree_sum = nullptr;
-  result = benchmark([&]() {
-    tree_sum = SparseMatrixTree::sumMatrices(tree_a, tree_b, false, false);
-  });
-  std::cout << "Soma: " << result.time_ms << " ms, Mem: " << result.memory_kb << " KB\n";
-  csv_file << "Tree,Soma," << n << "," << (sparsity * 100) << "," << k_expected << ","
-      << result.time_ms << "," << result.memory_kb << "\n";
-
-  // Multiplicação escalar
-  result = benchmark([&]() {
-    SparseMatrixTree::multScalarMatrix(tree_a, 5);
-  });
-  std::cout << "Mult Escalar: " << result.time_ms << " ms\n";
-  csv_file << "Tree,MultEscalar," << n << "," << (sparsity * 100) << "," << k_expected << ","
-      << result.time_ms << ",0\n";
-
-  // Multiplicação de matrizes
-  SparseMatrixTree::TreeNode *tree_mult = nullptr;
-  result = benchmark([&]() {
-    tree_mult = SparseMatrixTree::multMatrices(tree_a, tree_b, false, false);
-  });
-  std::cout << "Mult Matrizes: " << result.time_ms << " ms, Mem: "
-      << result.memory_kb << " KB\n";
-  csv_file << "Tree,MultMatrizes," << n << "," << (sparsity * 100) << "," << k_expected << ","
-      << result.time_ms << "," << result.memory_kb << "\n";
-  delete tree_mult;
-
-
-  delete tree_a;
-  delete tree_b;
-  delete tree_sum;
-}
+  }
 
-void DenseMatrixTest(const int n, const double sparsity, std::ofstream &csv_file, const long long k_expected) {
-  if (n > 10000) {
-    std::cout << "\n--- Matriz Densa (baseline) ---\n";
-    std::cout << "SKIPPED (n > 10000, impractical for dense matrices)\n";
-    csv_file << "Dense,Geracao," << n << "," << (sparsity * 100) << "," << k_expected << ",-1,0\n";
-    csv_file << "Dense,AcessoAleatorio," << n << "," << (sparsity * 100) << "," << k_expected << ",-1,0\n";
-    csv_file << "Dense,Insercao," << n << "," << (sparsity * 100) << "," << k_expected << ",-1,0\n";
-    csv_file << "Dense,Transposta," << n << "," << (sparsity * 100) << "," << k_expected << ",-1,0\n";
-    csv_file << "Dense,Soma," << n << "," << (sparsity * 100) << "," << k_expected << ",-1,0\n";
-    csv_file << "Dense,MultEscalar," << n << "," << (sparsity * 100) << "," << k_expected << ",-1,0\n";
-    csv_file << "Dense,MultMatrizes," << n << "," << (sparsity * 100) << "," << k_expected << ",-1,0\n";
-    return;
+  benchmarkOptions.warmups = std::max(benchmarkOptions.warmups, 0);
+  benchmarkOptions.repetitions = std::max(benchmarkOptions.repetitions, 1);
+  if (command.dimensions.empty()) {
+    command.dimensions = command.calibrate
+                           ? std::vector<int>{1000}
+                           : std::vector<int>{100, 1000, 10000, 100000, 1000000};
   }
 
-  std::cout << "\n--- Matriz Densa (baseline) ---\n";
+  return knownNames(command.filter.structures, BENCHMARK_STRUCTURES)
+         && knownNames(command.filter.operations, BENCHMARK_OPERATIONS);
+}
 
-  DenseMatrix dense_a(n, n);
-  DenseMatrix dense_b(n, n);
+int main(const int argc, char **argv) {
+  srand(20);
 
-  // Geração
-  auto result = benchmark([&]() {
-    dense_a = generateDenseMatrix(n, k_expected);
-  });
-  std::cout << "Geracao: " << result.time_ms << " ms, Mem: " << result.memory_kb << " KB\n";
-  csv_file << "Dense,Geracao," << n << "," << (sparsity * 100) << "," << k_expected << ","
-      << result.time_ms << "," << result.memory_kb << "\n";
+  CommandLine command;
+  if (!parseCommandLine(argc, argv, command)) {
+    printUsage(argv[0]);
+    return 1;
+  }
 
-  // Acesso
-  result = benchmark([&]() {
-    for (int t = 0; t < 1000; t++) {
-      int i = rand() % n, j = rand() % n;
-      dense_a.get(i, j);
-    }
-  });
-  std::cout << "Acesso Aleatorio (1000x): " << result.time_ms << " ms\n";
-  csv_file << "Dense,AcessoAleatorio," << n << "," << (sparsity * 100) << "," << k_expected << ","
-      << result.time_ms << ",0\n";
+  if (!ThreadPool::shared().pinThreads()) {
+    std::cout << "Aviso: nao foi possivel fixar as threads em nucleos\n";
+  }
 
-  // Inserção
-  result = benchmark([&]() {
-    for (int t = 0; t < 100; t++) {
-      int i = rand() % n, j = rand() % n;
-      double v = rand() % 9 + 1;
-      dense_a.set(i, j, v);
+  if (command.calibrate) {
+    for (const int n: command.dimensions) {
+      calibrateAdaptivePolicy(n);
     }
-  });
-  std::cout << "Insercao (100x): " << result.time_ms << " ms\n";
-  csv_file << "Dense,Insercao," << n << "," << (sparsity * 100) << "," << k_expected << ","
-      << result.time_ms << ",0\n";
-
-  // Transposta
-  DenseMatrix dense_t(n, n);
-  result = benchmark([&]() {
-    dense_t = dense_a.transpose();
-  });
-  std::cout << "Transposta: " << result.time_ms << " ms\n";
-  csv_file << "Dense,Transposta," << n << "," << (sparsity * 100) << "," << k_expected << ","
-      << result.time_ms << ",0\n";
-
-  // Soma
-  dense_b = generateDenseMatrix(n, k_expected);
-  DenseMatrix dense_sum(n, n);
-  result = benchmark([&]() {
-    dense_sum = dense_a.add(dense_b);
-  });
-  std::cout << "Soma: " << result.time_ms << " ms\n";
-  csv_file << "Dense,Soma," << n << "," << (sparsity * 100) << "," << k_expected << ","
-      << result.time_ms << ",0\n";
-
-  // Multiplicação escalar
-  DenseMatrix dense_scalar(n, n);
-  result = benchmark([&]() {
-    dense_scalar = dense_a.scalarMult(5);
-  });
-  std::cout << "Mult Escalar: " << result.time_ms << " ms\n";
-  csv_file << "Dense,MultEscalar," << n << "," << (sparsity * 100) << "," << k_expected << ","
-      << result.time_ms << ",0\n";
-
-  // Multiplicação de matrizes
-  if (n <= 1000) {
-    // Only run for small matrices
-    DenseMatrix dense_mult(n, n);
-    result = benchmark([&]() {
-      dense_mult = dense_a.mult(dense_b);
-    });
-    std::cout << "Mult Matrizes: " << result.time_ms << " ms\n";
-    csv_file << "Dense,MultMatrizes," << n << "," << (sparsity * 100) << ","
-        << k_expected << "," << result.time_ms << ",0\n";
-  } else {
-    std::cout << "Mult Matrizes: SKIPPED (too large)\n";
-    csv_file << "Dense,MultMatrizes," << n << "," << (sparsity * 100) << ","
-        << k_expected << ",-1,0\n";
+    return 0;
   }
-}
-
-int main() {
-  srand(20);
 
-  std::ofstream csv_file("resultados.csv");
-  csv_file << "Estrutura,Operacao,N,Esparsidade(%),K_Nao_Nulos,Tempo(ms),Memoria(KB)\n";
+  ResultWriter out(command.output + ".csv", command.output + ".json");
 
-  const std::vector dimensions = {100, 1000, 10000, 100000, 1000000};
+  for (const int n: command.dimensions) {
+    std::vector<double> sparsities = command.sparsities;
 
-  for (const int n: dimensions) {
-    std::vector<double> sparsities;
-
-    if (const int i = static_cast<int>(log10(n)); i < 4) {
-      sparsities = {0.01, 0.05, 0.10, 0.20};
-    } else {
-      sparsities = {
-        1.0 / pow(10, i + 2),
-        1.0 / pow(10, i + 1),
-        1.0 / pow(10, i)
-      };
+    if (sparsities.empty()) {
+      if (const int i = static_cast<int>(log10(n)); i < 4) {
+        sparsities = {0.01, 0.05, 0.10, 0.20};
+      } else {
+        sparsities = {
+          1.0 / pow(10, i + 2),
+          1.0 / pow(10, i + 1),
+          1.0 / pow(10, i)
+        };
+      }
     }
 
     for (const double sparsity: sparsities) {
@@ -400,17 +188,26 @@ int main() {
           << std::setprecision(6) << (sparsity * 100) << "%, k = " << k_expected << "\n";
       std::cout << "========================================\n";
 
-      SparseMatrixHashTest(n, sparsity, csv_file, k_expected);
+      if (command.filter.acceptsStructure("Hash")) {
+        SparseMatrixHashTest(n, sparsity, out, k_expected, command.filter);
+      }
+
+      if (command.filter.acceptsStructure("Tree")) {
+        SparseMatrixTreeTest(n, sparsity, out, k_expected, command.filter);
+      }
 
-      SparseMatrixTreeTest(n, sparsity, csv_file, k_expected);
+      if (command.filter.acceptsStructure("BPTree")) {
+        SparseMatrixBPTreeTest(n, sparsity, out, k_expected, command.filter);
+      }
 
-      DenseMatrixTest(n, sparsity, csv_file, k_expected);
+      if (command.filter.acceptsStructure("Dense")) {
+        DenseMatrixTest(n, sparsity, out, k_expected, command.filter);
+      }
     }
   }
 
-  csv_file.close();
   std::cout << "\n\n========================================\n";
-  std::cout << "Resultados salvos em 'resultados.csv'\n";
+  std::cout << "Resultados salvos em '" << command.output << ".csv' e '" << command.output << ".json'\n";
   std::cout << "========================================\n";
 
   return 0;
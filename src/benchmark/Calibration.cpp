@@ -0,0 +1,93 @@
+#include "Calibration.h"
+
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <tuple>
+#include <vector>
+
+#include "Harness.h"
+
+namespace {
+  const std::vector<double> CALIBRATION_FILLS = {
+    0.001, 0.002, 0.005, 0.01, 0.02, 0.05, 0.1, 0.15, 0.2, 0.3, 0.4, 0.5, 0.7, 1.0
+  };
+
+  // Poucas repetições: só interessa de que lado do cruzamento cada preenchimento está
+  const BenchmarkOptions CALIBRATION_OPTIONS{1, 3, 2000, false};
+
+  /// @brief Triplas em fill * n * n posições sorteadas (com repetição) e valores de 1 a 9
+  std::vector<std::tuple<int, int, double> > randomEntries(const int n, const double fill) {
+    const long long count = static_cast<long long>(fill * n * n);
+    std::vector<std::tuple<int, int, double> > entries;
+    entries.reserve(count);
+    for (long long e = 0; e < count; e++) {
+      entries.emplace_back(rand() % n, rand() % n, rand() % 9 + 1);
+    }
+    return entries;
+  }
+
+  DenseMatrix denseFromEntries(const int n, const std::vector<std::tuple<int, int, double> > &entries) {
+    DenseMatrix M(n, n);
+    for (const auto &[i, j, value]: entries) {
+      M.set(i, j, value);
+    }
+    return M;
+  }
+}
+
+AdaptivePolicy calibrateAdaptivePolicy(const int n) {
+  AdaptivePolicy policy;
+  double addCrossover = 1.0, multCrossover = 1.0;
+  bool multDone = false;
+
+  std::cout << "\n--- Calibracao da matriz adaptativa (n = " << n << ") ---\n";
+  for (const double fill: CALIBRATION_FILLS) {
+    const auto entries_a = randomEntries(n, fill);
+    const auto entries_b = randomEntries(n, fill);
+    const SparseMatrixCSR csr_a = SparseMatrixCSR::fromTriplets(n, n, entries_a);
+    const SparseMatrixCSR csr_b = SparseMatrixCSR::fromTriplets(n, n, entries_b);
+    const DenseMatrix dense_a = denseFromEntries(n, entries_a);
+    const DenseMatrix dense_b = denseFromEntries(n, entries_b);
+    // Preenchimento real, menor que fill por causa das posições sorteadas repetidas
+    const double actual = static_cast<double>(csr_a.nnz()) / (static_cast<double>(n) * n);
+
+    const double denseAdd = benchmark([&]() {
+      DenseMatrix C = dense_a + dense_b;
+    }, CALIBRATION_OPTIONS).time_ms;
+    const double sparseAdd = benchmark([&]() {
+      SparseMatrixCSR C = csr_a.add(csr_b);
+    }, CALIBRATION_OPTIONS).time_ms;
+    if (denseAdd <= sparseAdd && addCrossover == 1.0) {
+      addCrossover = actual;
+    }
+
+    std::cout << std::fixed << std::setprecision(4) << "Preenchimento " << actual
+        << std::setprecision(3) << ": soma densa " << denseAdd << " ms, comprimida " << sparseAdd << " ms";
+
+    // Depois do cruzamento o produto comprimido só piora, e fica caro demais para medir em preenchimentos altos
+    if (!multDone) {
+      const double denseMult = benchmark([&]() {
+        DenseMatrix C = dense_a.mult(dense_b);
+      }, CALIBRATION_OPTIONS).time_ms;
+      const double sparseMult = benchmark([&]() {
+        SparseMatrixCSR C = csr_a.mult(csr_b);
+      }, CALIBRATION_OPTIONS).time_ms;
+      if (denseMult <= sparseMult) {
+        multCrossover = actual;
+        multDone = true;
+      }
+      std::cout << "; produto denso " << denseMult << " ms, comprimido " << sparseMult << " ms";
+    }
+    std::cout << "\n";
+  }
+
+  policy.denseAbove = addCrossover;
+  policy.sparseBelow = addCrossover / 2;
+  policy.denseProductAbove = estimatedProductFill(multCrossover, multCrossover, n);
+
+  std::cout << std::setprecision(4) << "Limiares: denseAbove = " << policy.denseAbove
+      << ", sparseBelow = " << policy.sparseBelow
+      << ", denseProductAbove = " << policy.denseProductAbove << "\n";
+  return policy;
+}
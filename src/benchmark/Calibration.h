@@ -0,0 +1,10 @@
+#ifndef MC458_PROJETO_CALIBRATION_H
+#define MC458_PROJETO_CALIBRATION_H
+
+#include "../data_structures/adaptive_matrix/AdaptiveMatrix.h"
+
+// Mede, em matrizes n x n com preenchimentos crescentes, a partir de qual preenchimento a forma densa vence
+// a comprimida na soma e no produto, imprimindo cada medida, e devolve os limiares de AdaptivePolicy
+AdaptivePolicy calibrateAdaptivePolicy(int n);
+
+#endif //MC458_PROJETO_CALIBRATION_H
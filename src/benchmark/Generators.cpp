@@ -0,0 +1,62 @@
+#include "Generators.h"
+
+#include <cstdlib>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+SparseMatrixTree::TreeNode *generateSparseMatrixTree(SparseMatrixTree::NodeArena &arena, const int n,
+                                                     const long long k_expected) {
+  std::vector<std::tuple<int, int, double> > entries;
+  entries.reserve(k_expected);
+
+  for (long long count = 0; count < k_expected; count++) {
+    const int i = rand() % n;
+    const int j = rand() % n;
+    const double value = (rand() % 9) + 1;
+    entries.emplace_back(i, j, value);
+  }
+
+  return SparseMatrixTree::buildFromUnsorted(arena, std::move(entries));
+}
+
+SparseMatrixBPTree generateSparseMatrixBPTree(const int n, const long long k_expected) {
+  std::vector<std::tuple<int, int, double> > entries;
+  entries.reserve(k_expected);
+
+  for (long long count = 0; count < k_expected; count++) {
+    const int i = rand() % n;
+    const int j = rand() % n;
+    const double value = (rand() % 9) + 1;
+    entries.emplace_back(i, j, value);
+  }
+
+  return SparseMatrixBPTree::fromTriplets(n, n, std::move(entries));
+}
+
+SparseMatrixHash generateSparseMatrixHash(const int n, const long long k_expected) {
+  SparseMatrixHash M(n, n);
+
+  for (long long count = 0; count < k_expected; count++) {
+    const int i = rand() % n;
+    const int j = rand() % n;
+    const double value = (rand() % 9) + 1;
+    M.set(i, j, value);
+  }
+
+  return M;
+}
+
+DenseMatrix generateDenseMatrix(const int n, const long long k_expected) {
+  DenseMatrix M(n, n);
+
+  for (long long count = 0; count < k_expected; count++) {
+    const int i = rand() % n;
+    const int j = rand() % n;
+    const double value = (rand() % 9) + 1;
+    M.set(i, j, value);
+  }
+
+  return M;
+}
+
@@ -0,0 +1,18 @@
+#ifndef MC458_PROJETO_GENERATORS_H
+#define MC458_PROJETO_GENERATORS_H
+
+#include "../data_structures/dense_matrix/DenseMatrix.h"
+#include "../data_structures/sparse_matrix_hash/SparseMatrixHash.h"
+#include "../data_structures/sparse_matrix_tree/SparseMatrixTree.h"
+#include "../data_structures/sparse_matrix_bptree/SparseMatrixBPTree.h"
+
+// Geradores de matrizes n x n com k_expected posições sorteadas (com repetição) e valores de 1 a 9
+SparseMatrixTree::TreeNode *generateSparseMatrixTree(SparseMatrixTree::NodeArena &arena, int n, long long k_expected);
+
+SparseMatrixBPTree generateSparseMatrixBPTree(int n, long long k_expected);
+
+SparseMatrixHash generateSparseMatrixHash(int n, long long k_expected);
+
+DenseMatrix generateDenseMatrix(int n, long long k_expected);
+
+#endif //MC458_PROJETO_GENERATORS_H
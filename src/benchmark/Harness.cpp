@@ -0,0 +1,221 @@
+#include "Harness.h"
+
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <utility>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+BenchmarkOptions benchmarkOptions;
+
+namespace {
+  const char *const COUNTER_NAMES[PerfCounters::COUNT] = {
+    "ciclos", "instrucoes", "falhas_cache", "falhas_desvio", "falhas_tlb"
+  };
+}
+
+/// @brief Memória residente atual e de pico do processo. No Linux vem de /proc/self/status (VmRSS e VmHWM);
+///        sem /proc, getrusage só informa o pico, e a memória atual fica igual a ele
+MemoryUsage getMemoryUsageKB() {
+#ifdef _WIN32
+  PROCESS_MEMORY_COUNTERS pmc;
+  GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc));
+  return {pmc.WorkingSetSize / 1024, pmc.PeakWorkingSetSize / 1024};
+#else
+  MemoryUsage usage{0, 0};
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while (std::getline(status, line)) {
+    if (line.rfind("VmRSS:", 0) == 0) {
+      usage.current_kb = std::stoul(line.substr(6));
+    } else if (line.rfind("VmHWM:", 0) == 0) {
+      usage.peak_kb = std::stoul(line.substr(6));
+    }
+  }
+
+  if (usage.peak_kb == 0) {
+    rusage self{};
+    getrusage(RUSAGE_SELF, &self);
+#ifdef __APPLE__
+    usage.peak_kb = static_cast<size_t>(self.ru_maxrss) / 1024;
+#else
+    usage.peak_kb = static_cast<size_t>(self.ru_maxrss);
+#endif
+    if (usage.current_kb == 0) {
+      usage.current_kb = usage.peak_kb;
+    }
+  }
+  return usage;
+#endif
+}
+
+PerfCounters::PerfCounters() {
+  fds.fill(-1);
+#ifdef __linux__
+  const std::array<std::pair<std::uint32_t, std::uint64_t>, COUNT> events = {
+    {
+      {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+      {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+      {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+      {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+      {
+        PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                            | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)
+      }
+    }
+  };
+
+  for (int e = 0; e < COUNT; e++) {
+    perf_event_attr attr{};
+    attr.size = sizeof(attr);
+    attr.type = events[e].first;
+    attr.config = events[e].second;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    fds[e] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+  }
+#endif
+}
+
+PerfCounters::~PerfCounters() {
+#ifdef __linux__
+  for (const int fd: fds) {
+    if (fd >= 0) {
+      close(fd);
+    }
+  }
+#endif
+}
+
+void PerfCounters::start() {
+#ifdef __linux__
+  for (const int fd: fds) {
+    if (fd >= 0) {
+      ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+      ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+  }
+#endif
+}
+
+/// @brief Para a contagem e lê os valores, corrigidos pela fração do tempo em que cada contador
+///        esteve ativo quando o núcleo os multiplexa
+PerfCounters::Values PerfCounters::stop() {
+  Values values;
+  values.fill(-1);
+#ifdef __linux__
+  for (int e = 0; e < COUNT; e++) {
+    if (fds[e] < 0) {
+      continue;
+    }
+    ioctl(fds[e], PERF_EVENT_IOC_DISABLE, 0);
+    std::uint64_t data[3];
+    if (read(fds[e], data, sizeof(data)) == static_cast<ssize_t>(sizeof(data)) && data[2] > 0) {
+      values[e] = static_cast<long long>(static_cast<double>(data[0]) * data[1] / data[2] + 0.5);
+    }
+  }
+#endif
+  return values;
+}
+
+/// @brief Estatísticas das repetições cronometradas
+/// @param times tempos de cada repetição (ao menos um)
+/// @param counters soma dos contadores de hardware das repetições, ou -1 se indisponível
+BenchmarkResult summarize(std::vector<double> times, const size_t memory_kb, PerfCounters::Values counters) {
+  std::sort(times.begin(), times.end());
+  const size_t count = times.size();
+  const double median = count % 2 == 1 ? times[count / 2] : (times[count / 2 - 1] + times[count / 2]) / 2;
+  const size_t p95 = static_cast<size_t>(std::ceil(0.95 * static_cast<double>(count))) - 1;
+
+  double mean = 0;
+  for (const double time: times) {
+    mean += time;
+  }
+  mean /= static_cast<double>(count);
+
+  double variance = 0;
+  for (const double time: times) {
+    variance += (time - mean) * (time - mean);
+  }
+  variance = count > 1 ? variance / static_cast<double>(count - 1) : 0;
+
+  for (long long &counter: counters) {
+    if (counter >= 0) {
+      counter /= static_cast<long long>(count);
+    }
+  }
+
+  return {
+    median, times[p95], std::sqrt(variance), times.front(), mean, static_cast<int>(count), memory_kb,
+    getMemoryUsageKB().peak_kb, counters
+  };
+}
+
+ResultWriter::ResultWriter(const std::string &csvPath, const std::string &jsonPath) : csv(csvPath), json(jsonPath) {
+  csv << "Estrutura,Operacao,N,Esparsidade(%),K_Nao_Nulos,Tempo(ms),"
+      << "Ciclos,Instrucoes,FalhasCache,FalhasDesvio,FalhasTLB,Memoria(KB)\n";
+  json << "[";
+}
+
+ResultWriter::~ResultWriter() {
+  json << "\n]\n";
+}
+
+void ResultWriter::writeJson(const Scenario &scenario, const char *operation, const BenchmarkResult &result) {
+  json << (firstRecord ? "\n" : ",\n") << "  {\"estrutura\": \"" << scenario.structure
+      << "\", \"operacao\": \"" << operation << "\", \"n\": " << scenario.n
+      << ", \"esparsidade\": " << (scenario.sparsity * 100) << ", \"k\": " << scenario.k_expected
+      << ", \"tempo_ms\": " << result.time_ms << ", \"p95_ms\": " << result.p95_ms
+      << ", \"desvio_ms\": " << result.stddev_ms << ", \"min_ms\": " << result.min_ms
+      << ", \"media_ms\": " << result.mean_ms << ", \"repeticoes\": " << result.repetitions
+      << ", \"memoria_kb\": " << result.memory_kb << ", \"pico_rss_kb\": " << result.peak_kb;
+  for (int e = 0; e < PerfCounters::COUNT; e++) {
+    json << ", \"" << COUNTER_NAMES[e] << "\": " << result.counters[e];
+  }
+  json << "}";
+  firstRecord = false;
+}
+
+void ResultWriter::write(const Scenario &scenario, const char *operation, const BenchmarkResult &result) {
+  csv << scenario.structure << "," << operation << "," << scenario.n << "," << (scenario.sparsity * 100) << ","
+      << scenario.k_expected << "," << result.time_ms << ",";
+  for (const long long counter: result.counters) {
+    csv << counter << ",";
+  }
+  csv << result.memory_kb << std::endl;
+  writeJson(scenario, operation, result);
+}
+
+/// @brief Registra uma operação não executada: tempo -1, como no CSV original
+void ResultWriter::skip(const Scenario &scenario, const char *operation) {
+  write(scenario, operation, {-1, -1, 0, -1, -1, 0, 0, 0, {-1, -1, -1, -1, -1}});
+}
+
+/// @brief Mostra a medida no terminal e a grava nos arquivos de resultado
+void report(ResultWriter &out, const Scenario &scenario, const char *label, const char *operation,
+            const BenchmarkResult &result) {
+  std::cout << label << ": " << result.time_ms << " ms (p95 " << result.p95_ms << ", dp " << result.stddev_ms
+      << ", " << result.repetitions << "x), Mem: " << result.memory_kb << " KB";
+  if (result.counters[0] > 0 && result.counters[1] >= 0) {
+    std::cout << ", IPC " << static_cast<double>(result.counters[1]) / static_cast<double>(result.counters[0])
+        << ", falhas cache " << result.counters[2] << ", TLB " << result.counters[4];
+  }
+  std::cout << "\n";
+  out.write(scenario, operation, result);
+}
@@ -0,0 +1,165 @@
+#ifndef MC458_PROJETO_HARNESS_H
+#define MC458_PROJETO_HARNESS_H
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+struct MemoryUsage {
+  size_t current_kb;
+  size_t peak_kb;
+};
+
+MemoryUsage getMemoryUsageKB();
+
+// Contadores de hardware (perf_event_open) da thread que chama a operação: ciclos, instruções, falhas de
+// cache, falhas de previsão de desvio e falhas de dTLB, só em modo usuário. Tarefas executadas pelos
+// trabalhadores do ThreadPool não entram na contagem. Um contador que o núcleo ou a CPU não oferece vale -1
+class PerfCounters {
+public:
+  static constexpr int COUNT = 5;
+  using Values = std::array<long long, COUNT>;
+
+private:
+  std::array<int, COUNT> fds{};
+
+public:
+  PerfCounters();
+
+  PerfCounters(const PerfCounters &) = delete;
+
+  PerfCounters &operator=(const PerfCounters &) = delete;
+
+  ~PerfCounters();
+
+  void start();
+
+  Values stop();
+};
+
+struct BenchmarkOptions {
+  int warmups = 1;
+  int repetitions = 5;
+  double budget_ms = 10000; // repetições param depois deste tempo total (com ao menos uma medida)
+  bool counters = false; // coleta contadores de hardware nas repetições cronometradas
+};
+
+extern BenchmarkOptions benchmarkOptions;
+
+struct BenchmarkResult {
+  double time_ms; // mediana
+  double p95_ms;
+  double stddev_ms;
+  double min_ms;
+  double mean_ms;
+  int repetitions;
+  size_t memory_kb; // crescimento da memória residente na primeira execução
+  size_t peak_kb; // pico de memória residente do processo ao final
+  PerfCounters::Values counters; // média por repetição cronometrada, ou -1 se indisponível
+};
+
+BenchmarkResult summarize(std::vector<double> times, size_t memory_kb, PerfCounters::Values counters);
+
+// Executa func várias vezes: a primeira execução mede a memória e conta como aquecimento, seguida dos
+// aquecimentos restantes e das repetições cronometradas. setup roda antes de cada execução, fora do tempo,
+// para que operações que alteram a matriz sempre partam do mesmo estado
+template<typename Setup, typename Func>
+BenchmarkResult benchmark(Setup setup, Func func, const BenchmarkOptions &options = benchmarkOptions) {
+  size_t memory_kb = 0;
+  PerfCounters::Values counters;
+  counters.fill(-1);
+  std::unique_ptr<PerfCounters> perf;
+  if (options.counters) {
+    perf = std::make_unique<PerfCounters>();
+  }
+
+  auto run = [&](const bool measureMemory, const bool timed) {
+    setup();
+    const size_t mem_before = measureMemory ? getMemoryUsageKB().current_kb : 0;
+    const bool counting = perf && timed;
+    if (counting) {
+      perf->start();
+    }
+    const auto start = std::chrono::steady_clock::now();
+
+    func();
+
+    const auto end = std::chrono::steady_clock::now();
+    if (counting) {
+      const PerfCounters::Values values = perf->stop();
+      for (int e = 0; e < PerfCounters::COUNT; e++) {
+        if (values[e] >= 0) {
+          counters[e] = std::max(counters[e], 0LL) + values[e];
+        }
+      }
+    }
+    if (measureMemory) {
+      const size_t mem_after = getMemoryUsageKB().current_kb;
+      memory_kb = (mem_after > mem_before) ? (mem_after - mem_before) : 0;
+    }
+    return std::chrono::duration<double, std::milli>(end - start).count();
+  };
+
+  std::vector<double> times;
+  int warmups = options.warmups;
+  double spent = run(true, warmups == 0);
+  if (warmups > 0) {
+    warmups--;
+  } else {
+    times.push_back(spent);
+  }
+  for (; warmups > 0 && spent < options.budget_ms; warmups--) {
+    spent += run(false, false);
+  }
+  while (static_cast<int>(times.size()) < std::max(options.repetitions, 1)
+         && (times.empty() || spent < options.budget_ms)) {
+    times.push_back(run(false, true));
+    spent += times.back();
+  }
+
+  return summarize(std::move(times), memory_kb, counters);
+}
+
+template<typename Func>
+BenchmarkResult benchmark(Func func, const BenchmarkOptions &options = benchmarkOptions) {
+  return benchmark([]() {
+  }, func, options);
+}
+
+struct Scenario {
+  const char *structure;
+  int n;
+  double sparsity;
+  long long k_expected;
+};
+
+// Grava cada medida em um CSV (Tempo(ms) é a mediana) e, com todas as estatísticas, em um JSON
+class ResultWriter {
+  std::ofstream csv, json;
+  bool firstRecord = true;
+
+  void writeJson(const Scenario &scenario, const char *operation, const BenchmarkResult &result);
+
+public:
+  ResultWriter(const std::string &csvPath, const std::string &jsonPath);
+
+  ResultWriter(const ResultWriter &) = delete;
+
+  ResultWriter &operator=(const ResultWriter &) = delete;
+
+  ~ResultWriter();
+
+  void write(const Scenario &scenario, const char *operation, const BenchmarkResult &result);
+
+  void skip(const Scenario &scenario, const char *operation);
+};
+
+void report(ResultWriter &out, const Scenario &scenario, const char *label, const char *operation,
+            const BenchmarkResult &result);
+
+#endif //MC458_PROJETO_HARNESS_H
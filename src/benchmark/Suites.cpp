@@ -0,0 +1,441 @@
+#include "Suites.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <tuple>
+#include <utility>
+
+#include "Generators.h"
+
+const std::vector<std::string> BENCHMARK_STRUCTURES = {"Hash", "Tree", "BPTree", "Dense"};
+
+const std::vector<std::string> BENCHMARK_OPERATIONS = {
+  "Geracao", "AcessoExistente", "AcessoAleatorio", "AcessoLote", "Insercao", "Transposta", "Soma", "MultEscalar",
+  "MultMatrizes", "MultMatrizesParalela"
+};
+
+bool BenchmarkFilter::acceptsStructure(const std::string &structure) const {
+  return structures.empty() || std::find(structures.begin(), structures.end(), structure) != structures.end();
+}
+
+bool BenchmarkFilter::accepts(const std::string &operation) const {
+  return operations.empty() || std::find(operations.begin(), operations.end(), operation) != operations.end();
+}
+
+namespace {
+  /// @brief Mede e registra a operação se o filtro a aceitar
+  template<typename Setup, typename Func>
+  void measure(ResultWriter &out, const Scenario &scenario, const BenchmarkFilter &filter, const char *label,
+               const char *operation, Setup setup, Func func) {
+    if (filter.accepts(operation)) {
+      report(out, scenario, label, operation, benchmark(setup, func));
+    }
+  }
+
+  template<typename Func>
+  void measure(ResultWriter &out, const Scenario &scenario, const BenchmarkFilter &filter, const char *label,
+               const char *operation, Func func) {
+    measure(out, scenario, filter, label, operation, []() {
+    }, func);
+  }
+
+  /// @brief A geração é sempre executada, pois as demais operações dependem dela; só é medida se aceita
+  template<typename Func>
+  void generate(ResultWriter &out, const Scenario &scenario, const BenchmarkFilter &filter, Func func) {
+    if (filter.accepts("Geracao")) {
+      report(out, scenario, "Geracao", "Geracao", benchmark(func));
+    } else {
+      func();
+    }
+  }
+
+  /// @brief Sorteia as posições do acesso em lote fora da medição, de novo a cada repetição para que as linhas
+  ///        de cache trazidas pela anterior não sejam reaproveitadas
+  void drawPositions(const int n, std::vector<std::pair<int, int> > &positions) {
+    for (auto &[i, j]: positions) {
+      i = rand() % n;
+      j = rand() % n;
+    }
+  }
+
+  /// @brief Verdadeiro se alguma operação aceita usa a segunda matriz
+  bool needsSecondMatrix(const BenchmarkFilter &filter) {
+    return filter.accepts("Soma") || filter.accepts("MultMatrizes") || filter.accepts("MultMatrizesParalela");
+  }
+}
+
+void SparseMatrixHashTest(const int n, const double sparsity, ResultWriter &out, const long long k_expected,
+                          const BenchmarkFilter &filter) {
+  std::cout << "\n--- Estrutura 1 (E1): Hash Map ---\n";
+  const Scenario scenario{"Hash", n, sparsity, k_expected};
+
+  SparseMatrixHash hash_a(n, n);
+  SparseMatrixHash hash_b(n, n);
+
+  // Geração
+  generate(out, scenario, filter, [&]() {
+    hash_a = generateSparseMatrixHash(n, k_expected);
+  });
+
+  // Cria lista de posições existentes
+  std::vector<std::pair<int, int> > hash_existing;
+  for (auto [i, j, v]: hash_a.items()) {
+    if (hash_existing.size() < 1000) {
+      hash_existing.push_back({i, j});
+    }
+  }
+
+  // Acesso a elementos existentes
+  if (!hash_existing.empty()) {
+    measure(out, scenario, filter, "Acesso Existente (1000x)", "AcessoExistente", [&]() {
+      for (int t = 0; t < 1000 && t < static_cast<int>(hash_existing.size()); t++) {
+        auto [i, j] = hash_existing[t];
+        hash_a.get(i, j);
+      }
+    });
+  }
+
+  // Acesso aleatório
+  measure(out, scenario, filter, "Acesso Aleatorio (1000x)", "AcessoAleatorio", [&]() {
+    for (int t = 0; t < 1000; t++) {
+      int i = rand() % n, j = rand() % n;
+      hash_a.get(i, j);
+    }
+  });
+
+  // Acesso em lote: 1000 posições aleatórias com as faltas de cache sobrepostas
+  std::vector<std::pair<int, int> > batch_positions(1000);
+  std::vector<double> batch_values(batch_positions.size());
+  measure(out, scenario, filter, "Acesso em Lote (1000x)", "AcessoLote", [&]() {
+    drawPositions(n, batch_positions);
+  }, [&]() {
+    hash_a.getBatch(batch_positions.data(), batch_positions.size(), batch_values.data());
+  });
+
+  // Inserção
+  measure(out, scenario, filter, "Insercao (100x)", "Insercao", [&]() {
+    for (int t = 0; t < 100; t++) {
+      int i = rand() % n, j = rand() % n;
+      double v = rand() % 9 + 1;
+      hash_a.set(i, j, v);
+    }
+  });
+
+  // Transposta
+  measure(out, scenario, filter, "Transposta", "Transposta", [&]() {
+    SparseMatrixHash hash_t = hash_a.transpose();
+  });
+
+  if (needsSecondMatrix(filter)) {
+    hash_b = generateSparseMatrixHash(n, k_expected);
+  }
+
+  // Soma
+  SparseMatrixHash hash_sum(n, n);
+  measure(out, scenario, filter, "Soma", "Soma", [&]() {
+    hash_sum = hash_a.add(hash_b);
+  });
+
+  // Multiplicação escalar
+  SparseMatrixHash hash_scalar(n, n);
+  measure(out, scenario, filter, "Mult Escalar", "MultEscalar", [&]() {
+    hash_scalar = hash_a.scalarMult(5);
+  });
+
+  // Multiplicação de matrizes
+  SparseMatrixHash hash_mult(n, n);
+  measure(out, scenario, filter, "Mult Matrizes", "MultMatrizes", [&]() {
+    hash_mult = hash_a.mult(hash_b);
+  });
+
+  // Multiplicação de matrizes em paralelo
+  measure(out, scenario, filter, "Mult Matrizes Paralela", "MultMatrizesParalela", [&]() {
+    hash_mult = hash_a.multParallel(hash_b);
+  });
+}
+
+void SparseMatrixTreeTest(const int n, const double sparsity, ResultWriter &out, const long long k_expected,
+                          const BenchmarkFilter &filter) {
+  std::cout << "\n--- Estrutura 2 (E2): Red-Black Tree ---\n";
+  const Scenario scenario{"Tree", n, sparsity, k_expected};
+
+  SparseMatrixTree::NodeArena arena_a, arena_b, arena_sum, arena_mult;
+  SparseMatrixTree::TreeNode *tree_a = nullptr;
+  SparseMatrixTree::TreeNode *tree_b = nullptr;
+
+  // Geração
+  generate(out, scenario, filter, [&]() {
+    arena_a.clear();
+    tree_a = generateSparseMatrixTree(arena_a, n, k_expected);
+  });
+
+  // Cria lista de posições existentes para teste de acesso
+  std::vector<std::pair<int, int> > existing_positions;
+  std::vector<SparseMatrixTree::TreeNode *> nodes;
+  SparseMatrixTree::inorderGet(tree_a, false, nodes);
+  for (auto node: nodes) {
+    if (existing_positions.size() < 1000) {
+      existing_positions.push_back({node->row, node->column});
+    }
+  }
+
+  // Acesso a elementos existentes (Pior Caso)
+  if (!existing_positions.empty()) {
+    measure(out, scenario, filter, "Acesso Existente (1000x)", "AcessoExistente", [&]() {
+      for (int t = 0; t < 1000 && t < static_cast<int>(existing_positions.size()); t++) {
+        auto [i, j] = existing_positions[t];
+        SparseMatrixTree::findElement(tree_a, i, j, false);
+      }
+    });
+  }
+
+  // Acesso a elementos zero (Caso Médio)
+  measure(out, scenario, filter, "Acesso Aleatorio (1000x)", "AcessoAleatorio", [&]() {
+    for (int t = 0; t < 1000; t++) {
+      int i = rand() % n, j = rand() % n;
+      SparseMatrixTree::findElement(tree_a, i, j, false);
+    }
+  });
+
+  // Acesso em lote: as descidas de grupos de buscas são intercaladas
+  std::vector<std::pair<int, int> > batch_positions(1000);
+  std::vector<SparseMatrixTree::TreeNode *> batch_nodes(batch_positions.size());
+  measure(out, scenario, filter, "Acesso em Lote (1000x)", "AcessoLote", [&]() {
+    drawPositions(n, batch_positions);
+  }, [&]() {
+    SparseMatrixTree::findBatch(tree_a, batch_positions.data(), batch_positions.size(), false, batch_nodes.data());
+  });
+
+  // Inserção
+  measure(out, scenario, filter, "Insercao (100x)", "Insercao", [&]() {
+    for (int t = 0; t < 100; t++) {
+      int i = rand() % n, j = rand() % n;
+      int val = rand() % 9 + 1;
+      tree_a = SparseMatrixTree::insert(arena_a, tree_a, i, j, val);
+    }
+  });
+
+  // Transposta
+  // A árvore transpõe trocando a flag de orientação passada às operações
+  bool transpose_flag = false;
+  measure(out, scenario, filter, "Transposta", "Transposta", [&]() {
+    transpose_flag = !transpose_flag;
+  });
+
+  if (needsSecondMatrix(filter)) {
+    tree_b = generateSparseMatrixTree(arena_b, n, k_expected);
+  }
+
+  // Soma
+  // Cada repetição libera o resultado da anterior, para não acumular árvores nem medir blocos novos da arena
+  SparseMatrixTree::TreeNode *tree_sum = nullptr;
+  measure(out, scenario, filter, "Soma", "Soma", [&]() {
+    arena_sum.clear();
+  }, [&]() {
+    tree_sum = SparseMatrixTree::sumMatrices(arena_sum, tree_a, tree_b, false, false);
+  });
+
+  // Multiplicação escalar
+  // Multiplica sempre uma cópia recém-construída de tree_a, que segue intacta para as operações seguintes
+  SparseMatrixTree::NodeArena arena_scalar;
+  SparseMatrixTree::TreeNode *tree_scalar = nullptr;
+  std::vector<std::tuple<int, int, double> > entries_a;
+  if (filter.accepts("MultEscalar")) {
+    SparseMatrixTree::sortedEntries(tree_a, false, entries_a);
+  }
+  measure(out, scenario, filter, "Mult Escalar", "MultEscalar", [&]() {
+    arena_scalar.clear();
+    tree_scalar = SparseMatrixTree::buildFromSorted(arena_scalar, entries_a);
+  }, [&]() {
+    SparseMatrixTree::multScalarMatrix(tree_scalar, 5);
+  });
+
+  // Multiplicação de matrizes
+  SparseMatrixTree::TreeNode *tree_mult = nullptr;
+  measure(out, scenario, filter, "Mult Matrizes", "MultMatrizes", [&]() {
+    arena_mult.clear();
+  }, [&]() {
+    tree_mult = SparseMatrixTree::multMatrices(arena_mult, tree_a, tree_b, false, false);
+  });
+
+  // Multiplicação de matrizes em paralelo
+  SparseMatrixTree::NodeArena arena_mult_parallel;
+  measure(out, scenario, filter, "Mult Matrizes Paralela", "MultMatrizesParalela", [&]() {
+    arena_mult_parallel.clear();
+  }, [&]() {
+    tree_mult = SparseMatrixTree::multMatricesParallel(arena_mult_parallel, tree_a, tree_b, false, false);
+  });
+}
+
+void SparseMatrixBPTreeTest(const int n, const double sparsity, ResultWriter &out, const long long k_expected,
+                            const BenchmarkFilter &filter) {
+  std::cout << "\n--- Arvore B+ ---\n";
+  const Scenario scenario{"BPTree", n, sparsity, k_expected};
+
+  SparseMatrixBPTree bptree_a(n, n);
+  SparseMatrixBPTree bptree_b(n, n);
+
+  // Geração
+  generate(out, scenario, filter, [&]() {
+    bptree_a = generateSparseMatrixBPTree(n, k_expected);
+  });
+
+  // Cria lista de posições existentes
+  std::vector<std::pair<int, int> > existing_positions;
+  for (auto [i, j, v]: bptree_a.items()) {
+    if (existing_positions.size() >= 1000) {
+      break;
+    }
+    existing_positions.push_back({i, j});
+  }
+
+  // Acesso a elementos existentes
+  if (!existing_positions.empty()) {
+    measure(out, scenario, filter, "Acesso Existente (1000x)", "AcessoExistente", [&]() {
+      for (int t = 0; t < 1000 && t < static_cast<int>(existing_positions.size()); t++) {
+        auto [i, j] = existing_positions[t];
+        bptree_a.get(i, j);
+      }
+    });
+  }
+
+  // Acesso aleatório
+  measure(out, scenario, filter, "Acesso Aleatorio (1000x)", "AcessoAleatorio", [&]() {
+    for (int t = 0; t < 1000; t++) {
+      int i = rand() % n, j = rand() % n;
+      bptree_a.get(i, j);
+    }
+  });
+
+  // Acesso em lote: sem versão em lote, cada busca já visita poucos nós
+  if (filter.accepts("AcessoLote")) {
+    out.skip(scenario, "AcessoLote");
+  }
+
+  // Inserção
+  measure(out, scenario, filter, "Insercao (100x)", "Insercao", [&]() {
+    for (int t = 0; t < 100; t++) {
+      int i = rand() % n, j = rand() % n;
+      double v = rand() % 9 + 1;
+      bptree_a.set(i, j, v);
+    }
+  });
+
+  // Transposta
+  SparseMatrixBPTree bptree_t(n, n);
+  measure(out, scenario, filter, "Transposta", "Transposta", [&]() {
+    bptree_t = bptree_a.transpose();
+  });
+
+  if (needsSecondMatrix(filter)) {
+    bptree_b = generateSparseMatrixBPTree(n, k_expected);
+  }
+
+  // Soma (intercalação das folhas)
+  SparseMatrixBPTree bptree_sum(n, n);
+  measure(out, scenario, filter, "Soma", "Soma", [&]() {
+    bptree_sum = bptree_a.add(bptree_b);
+  });
+
+  // Multiplicação escalar
+  SparseMatrixBPTree bptree_scalar(n, n);
+  measure(out, scenario, filter, "Mult Escalar", "MultEscalar", [&]() {
+    bptree_scalar = bptree_a.scalarMult(5);
+  });
+
+  // Multiplicação de matrizes
+  SparseMatrixBPTree bptree_mult(n, n);
+  measure(out, scenario, filter, "Mult Matrizes", "MultMatrizes", [&]() {
+    bptree_mult = bptree_a.mult(bptree_b);
+  });
+
+  // Multiplicação de matrizes em paralelo
+  measure(out, scenario, filter, "Mult Matrizes Paralela", "MultMatrizesParalela", [&]() {
+    bptree_mult = bptree_a.multParallel(bptree_b);
+  });
+}
+
+void DenseMatrixTest(const int n, const double sparsity, ResultWriter &out, const long long k_expected,
+                     const BenchmarkFilter &filter) {
+  const Scenario scenario{"Dense", n, sparsity, k_expected};
+  if (n > 10000) {
+    std::cout << "\n--- Matriz Densa (baseline) ---\n";
+    std::cout << "SKIPPED (n > 10000, impractical for dense matrices)\n";
+    for (const std::string &operation: BENCHMARK_OPERATIONS) {
+      if (operation != "AcessoExistente" && filter.accepts(operation)) {
+        out.skip(scenario, operation.c_str());
+      }
+    }
+    return;
+  }
+
+  std::cout << "\n--- Matriz Densa (baseline) ---\n";
+
+  DenseMatrix dense_a(n, n);
+  DenseMatrix dense_b(n, n);
+
+  // Geração
+  generate(out, scenario, filter, [&]() {
+    dense_a = generateDenseMatrix(n, k_expected);
+  });
+
+  // Acesso
+  measure(out, scenario, filter, "Acesso Aleatorio (1000x)", "AcessoAleatorio", [&]() {
+    for (int t = 0; t < 1000; t++) {
+      int i = rand() % n, j = rand() % n;
+      dense_a.get(i, j);
+    }
+  });
+
+  // Acesso em lote
+  std::vector<std::pair<int, int> > batch_positions(1000);
+  std::vector<double> batch_values(batch_positions.size());
+  measure(out, scenario, filter, "Acesso em Lote (1000x)", "AcessoLote", [&]() {
+    drawPositions(n, batch_positions);
+  }, [&]() {
+    dense_a.getBatch(batch_positions.data(), batch_positions.size(), batch_values.data());
+  });
+
+  // Inserção
+  measure(out, scenario, filter, "Insercao (100x)", "Insercao", [&]() {
+    for (int t = 0; t < 100; t++) {
+      int i = rand() % n, j = rand() % n;
+      double v = rand() % 9 + 1;
+      dense_a.set(i, j, v);
+    }
+  });
+
+  // Transposta
+  DenseMatrix dense_t(n, n);
+  measure(out, scenario, filter, "Transposta", "Transposta", [&]() {
+    dense_t = dense_a.transpose();
+  });
+
+  if (needsSecondMatrix(filter)) {
+    dense_b = generateDenseMatrix(n, k_expected);
+  }
+
+  // Soma
+  DenseMatrix dense_sum(n, n);
+  measure(out, scenario, filter, "Soma", "Soma", [&]() {
+    dense_sum = dense_a.add(dense_b);
+  });
+
+  // Multiplicação escalar
+  DenseMatrix dense_scalar(n, n);
+  measure(out, scenario, filter, "Mult Escalar", "MultEscalar", [&]() {
+    dense_scalar = dense_a.scalarMult(5);
+  });
+
+  // Multiplicação de matrizes
+  DenseMatrix dense_mult(n, n);
+  measure(out, scenario, filter, "Mult Matrizes", "MultMatrizes", [&]() {
+    dense_mult = dense_a.mult(dense_b);
+  });
+
+  // Multiplicação de matrizes em paralelo
+  measure(out, scenario, filter, "Mult Matrizes Paralela", "MultMatrizesParalela", [&]() {
+    dense_mult = dense_a.multParallel(dense_b);
+  });
+}
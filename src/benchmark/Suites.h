@@ -0,0 +1,36 @@
+#ifndef MC458_PROJETO_SUITES_H
+#define MC458_PROJETO_SUITES_H
+
+#include <string>
+#include <vector>
+
+#include "Harness.h"
+
+// Estruturas e operações a medir, pelos nomes usados no CSV (Hash, Tree, BPTree, Dense; Geracao, Soma, ...).
+// Uma lista vazia aceita todos
+struct BenchmarkFilter {
+  std::vector<std::string> structures;
+  std::vector<std::string> operations;
+
+  bool acceptsStructure(const std::string &structure) const;
+
+  bool accepts(const std::string &operation) const;
+};
+
+extern const std::vector<std::string> BENCHMARK_STRUCTURES;
+
+extern const std::vector<std::string> BENCHMARK_OPERATIONS;
+
+void SparseMatrixHashTest(int n, double sparsity, ResultWriter &out, long long k_expected,
+                          const BenchmarkFilter &filter = {});
+
+void SparseMatrixTreeTest(int n, double sparsity, ResultWriter &out, long long k_expected,
+                          const BenchmarkFilter &filter = {});
+
+void SparseMatrixBPTreeTest(int n, double sparsity, ResultWriter &out, long long k_expected,
+                            const BenchmarkFilter &filter = {});
+
+void DenseMatrixTest(int n, double sparsity, ResultWriter &out, long long k_expected,
+                     const BenchmarkFilter &filter = {});
+
+#endif //MC458_PROJETO_SUITES_H
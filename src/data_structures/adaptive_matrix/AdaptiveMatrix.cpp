@@ -0,0 +1,574 @@
+#include "AdaptiveMatrix.h"
+
+#include <cassert>
+#include <cmath>
+#include <type_traits>
+#include <utility>
+
+const char *representationName(const MatrixRepresentation representation) {
+  switch (representation) {
+    case MatrixRepresentation::DENSE:
+      return "Dense";
+    case MatrixRepresentation::HASH:
+      return "Hash";
+    case MatrixRepresentation::TREE:
+      return "Tree";
+    case MatrixRepresentation::COMPRESSED:
+      return "CSR";
+  }
+  return "?";
+}
+
+/// @brief Preenchimento esperado de A * B supondo posições não nulas independentes: C(i, j) é nulo só
+///        se nenhum dos depth produtos A(i, k) * B(k, j) tiver os dois fatores não nulos
+/// @param depth dimensão interna (colunas de A, linhas de B)
+double estimatedProductFill(const double densityA, const double densityB, const int depth) {
+  const double pair = densityA * densityB;
+  if (pair >= 1) {
+    return 1;
+  }
+  return -std::expm1(depth * std::log1p(-pair));
+}
+
+template<typename T>
+BasicAdaptiveMatrix<T>::OwnedTree::OwnedTree(const int n, const int m,
+                                             const std::vector<std::tuple<int, int, T> > &sortedEntries)
+  : n{n}, m{m}, arena{std::make_unique<typename Tree::NodeArena>()},
+    root{Tree::buildFromSorted(*arena, sortedEntries)} {
+}
+
+template<typename T>
+BasicAdaptiveMatrix<T>::OwnedTree::OwnedTree(const OwnedTree &other)
+  : OwnedTree(other.n, other.m, other.entries()) {
+}
+
+template<typename T>
+typename BasicAdaptiveMatrix<T>::OwnedTree &BasicAdaptiveMatrix<T>::OwnedTree::operator=(const OwnedTree &other) {
+  if (this != &other) {
+    *this = OwnedTree(other);
+  }
+  return *this;
+}
+
+template<typename T>
+std::vector<std::tuple<int, int, T> > BasicAdaptiveMatrix<T>::OwnedTree::entries(const bool transpose) const {
+  std::vector<std::tuple<int, int, T> > entries;
+  Tree::sortedEntries(root, transpose, entries);
+  if (scale != T(1)) {
+    for (auto &entry: entries) {
+      std::get<2>(entry) *= scale;
+    }
+  }
+  return entries;
+}
+
+template<typename T>
+void BasicAdaptiveMatrix<T>::OwnedTree::materialize() {
+  if (scale != T(1)) {
+    Tree::multScalarMatrix(root, scale);
+    scale = T(1);
+  }
+}
+
+template<typename T>
+template<typename Storage>
+BasicAdaptiveMatrix<T>::BasicAdaptiveMatrix(const int n, const int m, const AdaptivePolicy &policy,
+                                            Storage &&storage)
+  : n{n}, m{m}, policy{policy}, storage{std::forward<Storage>(storage)} {
+  if constexpr (std::is_same_v<std::decay_t<Storage>, Dense>) {
+    countDenseNonzeros();
+  }
+}
+
+/// @brief Se uma matriz rows x cols cabe na forma densa dentro de policy.denseMaxBytes
+template<typename T>
+bool BasicAdaptiveMatrix<T>::denseFits(const int rows, const int cols) const {
+  return static_cast<double>(rows) * cols * sizeof(T) <= static_cast<double>(policy.denseMaxBytes);
+}
+
+/// @brief Conta os não nulos da forma densa guardada, em O(n * m); chamada só quando a matriz passa a ser densa
+template<typename T>
+void BasicAdaptiveMatrix<T>::countDenseNonzeros() {
+  const Dense &A = std::get<Dense>(storage);
+  denseNonzeros = 0;
+  for (int i = 0; i < n; i++) {
+    const T *row = A.rowData(i);
+    for (int j = 0; j < m; j++) {
+      denseNonzeros += A.scaleFactor() * row[j] != T{};
+    }
+  }
+}
+
+/// @brief Matriz n x m sem elementos não nulos, na hash, pronta para receber inserções
+template<typename T>
+BasicAdaptiveMatrix<T>::BasicAdaptiveMatrix(const int n, const int m, const AdaptivePolicy &policy)
+  : BasicAdaptiveMatrix(n, m, policy, Hash(n, m)) {
+}
+
+template<typename T>
+BasicAdaptiveMatrix<T>::BasicAdaptiveMatrix(Dense A, const AdaptivePolicy &policy)
+  : BasicAdaptiveMatrix(A.rows(), A.cols(), policy, std::move(A)) {
+}
+
+template<typename T>
+BasicAdaptiveMatrix<T>::BasicAdaptiveMatrix(Hash A, const AdaptivePolicy &policy)
+  : BasicAdaptiveMatrix(A.rows(), A.cols(), policy, std::move(A)) {
+}
+
+template<typename T>
+BasicAdaptiveMatrix<T>::BasicAdaptiveMatrix(CSR A, const AdaptivePolicy &policy)
+  : BasicAdaptiveMatrix(A.rows(), A.cols(), policy, std::move(A)) {
+}
+
+/// @brief Monta a matriz comprimida a partir das triplas e a deixa na representação do seu preenchimento
+/// @param entries triplas (linha, coluna, valor) em qualquer ordem; posições repetidas são somadas
+template<typename T>
+BasicAdaptiveMatrix<T> BasicAdaptiveMatrix<T>::fromTriplets(const int n, const int m,
+                                                            const std::vector<std::tuple<int, int, T> > &entries,
+                                                            const AdaptivePolicy &policy) {
+  BasicAdaptiveMatrix A(CSR::fromTriplets(n, m, entries), policy);
+  A.adapt();
+  return A;
+}
+
+template<typename T>
+int BasicAdaptiveMatrix<T>::rows() const {
+  return n;
+}
+
+template<typename T>
+int BasicAdaptiveMatrix<T>::cols() const {
+  return m;
+}
+
+/// @brief Número de elementos guardados; na forma densa, os não nulos contados quando ela foi criada
+template<typename T>
+size_t BasicAdaptiveMatrix<T>::nnz() const {
+  switch (representation()) {
+    case MatrixRepresentation::DENSE:
+      return denseNonzeros;
+    case MatrixRepresentation::HASH:
+      return std::get<Hash>(storage).nnz();
+    case MatrixRepresentation::TREE:
+      return std::get<OwnedTree>(storage).arena->size();
+    case MatrixRepresentation::COMPRESSED:
+      return std::get<CSR>(storage).nnz();
+  }
+  return 0;
+}
+
+template<typename T>
+double BasicAdaptiveMatrix<T>::density() const {
+  const double total = static_cast<double>(n) * m;
+  return total > 0 ? nnz() / total : 0;
+}
+
+template<typename T>
+MatrixRepresentation BasicAdaptiveMatrix<T>::representation() const {
+  return static_cast<MatrixRepresentation>(storage.index());
+}
+
+template<typename T>
+T BasicAdaptiveMatrix<T>::get(const int i, const int j) const {
+  assert(0 <= i && i < n && 0 <= j && j < m);
+
+  switch (representation()) {
+    case MatrixRepresentation::DENSE:
+      return std::get<Dense>(storage).get(i, j);
+    case MatrixRepresentation::HASH:
+      return std::get<Hash>(storage).get(i, j);
+    case MatrixRepresentation::TREE: {
+      const OwnedTree &tree = std::get<OwnedTree>(storage);
+      const typename Tree::TreeNode *node = Tree::findElement(tree.root, i, j, false);
+      return node == nullptr ? T{} : tree.scale * node->value;
+    }
+    case MatrixRepresentation::COMPRESSED:
+      break;
+  }
+  return std::get<CSR>(storage).get(i, j);
+}
+
+/// @brief Lê count posições com o getBatch da representação atual, que sobrepõe as faltas de cache das
+///        buscas; a forma comprimida, sem versão em lote, busca uma a uma
+template<typename T>
+void BasicAdaptiveMatrix<T>::getBatch(const std::pair<int, int> *positions, const size_t count, T *values) const {
+  switch (representation()) {
+    case MatrixRepresentation::DENSE:
+      std::get<Dense>(storage).getBatch(positions, count, values);
+      return;
+    case MatrixRepresentation::HASH:
+      std::get<Hash>(storage).getBatch(positions, count, values);
+      return;
+    case MatrixRepresentation::TREE: {
+      const OwnedTree &tree = std::get<OwnedTree>(storage);
+      std::vector<typename Tree::TreeNode *> found(count);
+      Tree::findBatch(tree.root, positions, count, false, found.data());
+      for (size_t t = 0; t < count; t++) {
+        values[t] = found[t] == nullptr ? T{} : tree.scale * found[t]->value;
+      }
+      return;
+    }
+    case MatrixRepresentation::COMPRESSED:
+      break;
+  }
+  const CSR &compressed = std::get<CSR>(storage);
+  for (size_t t = 0; t < count; t++) {
+    values[t] = compressed.get(positions[t].first, positions[t].second);
+  }
+}
+
+/// @brief Escreve um elemento. A forma comprimida passa para a hash antes, e uma hash ou árvore que
+///        alcança policy.denseAbove passa para a forma densa, se ela couber em policy.denseMaxBytes
+template<typename T>
+void BasicAdaptiveMatrix<T>::set(const int i, const int j, const T value) {
+  assert(0 <= i && i < n && 0 <= j && j < m);
+
+  if (representation() == MatrixRepresentation::COMPRESSED) {
+    convertTo(MatrixRepresentation::HASH);
+  }
+
+  if (OwnedTree *tree = std::get_if<OwnedTree>(&storage)) {
+    tree->materialize();
+    tree->root = Tree::set(*tree->arena, tree->root, i, j, value);
+  } else if (Dense *dense = std::get_if<Dense>(&storage)) {
+    denseNonzeros -= dense->get(i, j) != T{};
+    denseNonzeros += value != T{};
+    dense->set(i, j, value);
+    return;
+  } else {
+    std::get<Hash>(storage).set(i, j, value);
+  }
+
+  if (density() >= policy.denseAbove && denseFits(n, m)) {
+    convertTo(MatrixRepresentation::DENSE);
+  }
+}
+
+/// @brief Converte o armazenamento para a representação pedida, passando pela forma comprimida quando a
+///        origem e o destino são ambos esparsos e diferentes
+template<typename T>
+void BasicAdaptiveMatrix<T>::convertTo(const MatrixRepresentation representation) {
+  if (representation == this->representation()) {
+    return;
+  }
+
+  switch (representation) {
+    case MatrixRepresentation::DENSE:
+      storage = toDense();
+      countDenseNonzeros();
+      break;
+    case MatrixRepresentation::COMPRESSED:
+      storage = toCompressed();
+      break;
+    case MatrixRepresentation::HASH: {
+      BasicFlatHashMap<T> data;
+      data.reserve(nnz());
+      for (const auto &[i, j, value]: items()) {
+        if (value != T{}) {
+          data[BasicFlatHashMap<T>::pack(i, j)] = value;
+        }
+      }
+      storage = Hash(n, m, false, std::move(data));
+      break;
+    }
+    case MatrixRepresentation::TREE:
+      storage = OwnedTree(n, m, toCompressed().toRowMajor().items());
+      break;
+  }
+}
+
+/// @brief Escolhe a representação pelo preenchimento atual: densa a partir de policy.denseAbove (se couber em
+///        policy.denseMaxBytes), e uma matriz densa abaixo de policy.sparseBelow volta à forma comprimida. A
+///        distância entre os dois limiares evita converter a matriz de um lado para o outro a cada operação
+template<typename T>
+void BasicAdaptiveMatrix<T>::adapt() {
+  const double fill = density();
+  if (fill >= policy.denseAbove && denseFits(n, m)) {
+    convertTo(MatrixRepresentation::DENSE);
+  } else if (fill < policy.sparseBelow && representation() == MatrixRepresentation::DENSE) {
+    convertTo(MatrixRepresentation::COMPRESSED);
+  }
+}
+
+template<typename T>
+BasicDenseMatrix<T> BasicAdaptiveMatrix<T>::toDense() const {
+  if (const Dense *dense = std::get_if<Dense>(&storage)) {
+    return *dense;
+  }
+
+  Dense A(n, m);
+  for (const auto &[i, j, value]: items()) {
+    A.set(i, j, value);
+  }
+  return A;
+}
+
+template<typename T>
+BasicSparseMatrixCSR<T> BasicAdaptiveMatrix<T>::toCompressed() const {
+  switch (representation()) {
+    case MatrixRepresentation::DENSE:
+      return CSR::fromTriplets(n, m, items());
+    case MatrixRepresentation::HASH:
+      return CSR::fromHash(std::get<Hash>(storage));
+    case MatrixRepresentation::TREE: {
+      const OwnedTree &tree = std::get<OwnedTree>(storage);
+      const CSR A = CSR::fromTree(tree.root, n, m, false);
+      return tree.scale == T(1) ? A : A.scalarMult(tree.scale);
+    }
+    case MatrixRepresentation::COMPRESSED:
+      break;
+  }
+  return std::get<CSR>(storage);
+}
+
+template<typename T>
+std::vector<std::tuple<int, int, T> > BasicAdaptiveMatrix<T>::items() const {
+  switch (representation()) {
+    case MatrixRepresentation::DENSE:
+      break;
+    case MatrixRepresentation::HASH:
+      return std::get<Hash>(storage).items();
+    case MatrixRepresentation::TREE:
+      return std::get<OwnedTree>(storage).entries();
+    case MatrixRepresentation::COMPRESSED:
+      return std::get<CSR>(storage).items();
+  }
+
+  const Dense &A = std::get<Dense>(storage);
+  std::vector<std::tuple<int, int, T> > items;
+  for (int i = 0; i < n; i++) {
+    const T *row = A.rowData(i);
+    for (int j = 0; j < m; j++) {
+      if (const T value = A.scaleFactor() * row[j]; value != T{}) {
+        items.emplace_back(i, j, value);
+      }
+    }
+  }
+  return items;
+}
+
+/// @brief A matriz densa guardada, ou a conversão dela em scratch
+template<typename T>
+const BasicDenseMatrix<T> &BasicAdaptiveMatrix<T>::denseOf(Dense &scratch) const {
+  if (const Dense *dense = std::get_if<Dense>(&storage)) {
+    return *dense;
+  }
+  scratch = toDense();
+  return scratch;
+}
+
+/// @brief A matriz comprimida guardada, ou a conversão dela em scratch
+template<typename T>
+const BasicSparseMatrixCSR<T> &BasicAdaptiveMatrix<T>::compressedOf(CSR &scratch) const {
+  if (const CSR *compressed = std::get_if<CSR>(&storage)) {
+    return *compressed;
+  }
+  scratch = toCompressed();
+  return scratch;
+}
+
+/// @brief Transposta na mesma representação; O(1) nas formas hash e comprimida, que compartilham o armazenamento
+template<typename T>
+BasicAdaptiveMatrix<T> BasicAdaptiveMatrix<T>::transpose() const {
+  switch (representation()) {
+    case MatrixRepresentation::DENSE:
+      return BasicAdaptiveMatrix(std::get<Dense>(storage).transpose(), policy);
+    case MatrixRepresentation::HASH:
+      return BasicAdaptiveMatrix(std::get<Hash>(storage).transpose(), policy);
+    case MatrixRepresentation::TREE:
+      return BasicAdaptiveMatrix(m, n, policy, OwnedTree(m, n, std::get<OwnedTree>(storage).entries(true)));
+    case MatrixRepresentation::COMPRESSED:
+      break;
+  }
+  return BasicAdaptiveMatrix(std::get<CSR>(storage).transpose(), policy);
+}
+
+/// @brief Bloco [r0, r1) x [c0, c1), extraído na representação atual em tempo proporcional ao bloco (ver a
+///        extração de cada estrutura) e então ajustado ao preenchimento do bloco
+template<typename T>
+BasicAdaptiveMatrix<T> BasicAdaptiveMatrix<T>::submatrix(const int r0, const int r1, const int c0, const int c1) const {
+  assert(0 <= r0 && r0 <= r1 && r1 <= n && 0 <= c0 && c0 <= c1 && c1 <= m);
+
+  const auto adapted = [](BasicAdaptiveMatrix C) {
+    C.adapt();
+    return C;
+  };
+
+  switch (representation()) {
+    case MatrixRepresentation::DENSE:
+      return adapted(BasicAdaptiveMatrix(std::get<Dense>(storage).submatrix(r0, r1, c0, c1), policy));
+    case MatrixRepresentation::HASH:
+      return adapted(BasicAdaptiveMatrix(std::get<Hash>(storage).submatrix(r0, r1, c0, c1), policy));
+    case MatrixRepresentation::TREE: {
+      const OwnedTree &tree = std::get<OwnedTree>(storage);
+      OwnedTree block(r1 - r0, c1 - c0, {});
+      block.root = Tree::submatrix(*block.arena, tree.root, false, r0, r1, c0, c1);
+      block.scale = tree.scale;
+      return adapted(BasicAdaptiveMatrix(r1 - r0, c1 - c0, policy, std::move(block)));
+    }
+    case MatrixRepresentation::COMPRESSED:
+      break;
+  }
+  return adapted(BasicAdaptiveMatrix(std::get<CSR>(storage).submatrix(r0, r1, c0, c1), policy));
+}
+
+/// @brief Soma. Custa O(n * m) na forma densa e O(nnz(A) + nnz(B)) por intercalação das formas
+///        comprimidas; a densa é usada quando o preenchimento médio dos operandos alcança policy.denseAbove,
+///        e o resultado é então ajustado pelo preenchimento que de fato teve
+template<typename T>
+BasicAdaptiveMatrix<T> BasicAdaptiveMatrix<T>::add(const BasicAdaptiveMatrix &B) const {
+  assert(n == B.n && m == B.m);
+
+  if ((density() + B.density()) / 2 >= policy.denseAbove && denseFits(n, m)) {
+    Dense scratchA(0, 0), scratchB(0, 0);
+    BasicAdaptiveMatrix C(Dense(denseOf(scratchA) + B.denseOf(scratchB)), policy);
+    C.adapt();
+    return C;
+  }
+
+  CSR scratchA(0, 0), scratchB(0, 0);
+  BasicAdaptiveMatrix C(compressedOf(scratchA).add(B.compressedOf(scratchB)), policy);
+  C.adapt();
+  return C;
+}
+
+template<typename T>
+BasicAdaptiveMatrix<T> BasicAdaptiveMatrix<T>::operator+(const BasicAdaptiveMatrix &B) const {
+  return add(B);
+}
+
+/// @brief Multiplicação por escalar na mesma representação
+template<typename T>
+BasicAdaptiveMatrix<T> BasicAdaptiveMatrix<T>::scalarMult(const T alpha) const {
+  BasicAdaptiveMatrix C = *this;
+  C *= alpha;
+  return C;
+}
+
+/// @brief Multiplicação por escalar em O(1) nas formas densa, hash e árvore, que guardam o fator pendente;
+///        a forma comprimida, imutável, é copiada com os valores multiplicados
+template<typename T>
+BasicAdaptiveMatrix<T> &BasicAdaptiveMatrix<T>::operator*=(const T alpha) {
+  if (alpha == T{}) {
+    storage = CSR(n, m);
+    return *this;
+  }
+
+  switch (representation()) {
+    case MatrixRepresentation::DENSE:
+      std::get<Dense>(storage) *= alpha;
+      break;
+    case MatrixRepresentation::HASH:
+      std::get<Hash>(storage) *= alpha;
+      break;
+    case MatrixRepresentation::TREE:
+      std::get<OwnedTree>(storage).scale *= alpha;
+      break;
+    case MatrixRepresentation::COMPRESSED:
+      storage = std::get<CSR>(storage).scalarMult(alpha);
+      break;
+  }
+  return *this;
+}
+
+/// @brief Produto escolhido pelo preenchimento estimado do resultado: a partir de policy.denseProductAbove
+///        as duas matrizes são multiplicadas na forma densa; senão uma esparsa multiplica a forma densa de
+///        B, se B já for densa, ou a forma comprimida de B (Gustavson). O resultado esparso que sair mais
+///        cheio que o estimado passa para a forma densa em adapt
+template<typename T>
+BasicAdaptiveMatrix<T> BasicAdaptiveMatrix<T>::product(const BasicAdaptiveMatrix &B, ThreadPool *pool) const {
+  assert(m == B.n);
+
+  if (estimatedProductFill(density(), B.density(), m) >= policy.denseProductAbove && denseFits(n, m)
+      && denseFits(B.n, B.m) && denseFits(n, B.m)) {
+    Dense scratchA(0, 0), scratchB(0, 0);
+    const Dense &a = denseOf(scratchA);
+    const Dense &b = B.denseOf(scratchB);
+    BasicAdaptiveMatrix C(pool ? a.multParallel(b, *pool) : a.mult(b), policy);
+    C.adapt();
+    return C;
+  }
+
+  CSR scratchA(0, 0);
+  const CSR &a = compressedOf(scratchA);
+  if (const Dense *b = std::get_if<Dense>(&B.storage)) {
+    BasicAdaptiveMatrix C(pool ? a.multDenseParallel(*b, false, *pool) : a.multDense(*b), policy);
+    C.adapt();
+    return C;
+  }
+
+  CSR scratchB(0, 0);
+  const CSR &b = B.compressedOf(scratchB);
+  BasicAdaptiveMatrix C(pool ? a.multParallel(b, *pool) : a.mult(b), policy);
+  C.adapt();
+  return C;
+}
+
+template<typename T>
+BasicAdaptiveMatrix<T> BasicAdaptiveMatrix<T>::mult(const BasicAdaptiveMatrix &B) const {
+  return product(B, nullptr);
+}
+
+template<typename T>
+BasicAdaptiveMatrix<T> BasicAdaptiveMatrix<T>::multParallel(const BasicAdaptiveMatrix &B, ThreadPool &pool) const {
+  return product(B, &pool);
+}
+
+template<typename T>
+BasicAdaptiveMatrix<T> BasicAdaptiveMatrix<T>::operator*(const BasicAdaptiveMatrix &B) const {
+  return mult(B);
+}
+
+/// @brief Produto matriz-vetor na representação atual, sem convertê-la
+template<typename T>
+std::vector<T> BasicAdaptiveMatrix<T>::multVector(const std::vector<T> &x) const {
+  assert(x.size() == static_cast<size_t>(m));
+
+  switch (representation()) {
+    case MatrixRepresentation::DENSE: {
+      const Dense &A = std::get<Dense>(storage);
+      std::vector<T> y(n, T{});
+      for (int i = 0; i < n; i++) {
+        const T *row = A.rowData(i);
+        T sum{};
+        for (int j = 0; j < m; j++) {
+          sum += row[j] * x[j];
+        }
+        y[i] = A.scaleFactor() * sum;
+      }
+      return y;
+    }
+    case MatrixRepresentation::HASH:
+      return std::get<Hash>(storage).multVector(x);
+    case MatrixRepresentation::TREE: {
+      const OwnedTree &tree = std::get<OwnedTree>(storage);
+      std::vector<T> y(n, T{});
+      Tree::multVector(tree.root, false, x, y);
+      for (T &value: y) {
+        value *= tree.scale;
+      }
+      return y;
+    }
+    case MatrixRepresentation::COMPRESSED:
+      break;
+  }
+  return std::get<CSR>(storage).multVector(x);
+}
+
+template<typename T>
+std::ostream &operator<<(std::ostream &os, const BasicAdaptiveMatrix<T> &M) {
+  os << "AdaptiveMatrix(" << M.n << "x" << M.m
+      << ", nnz=" << M.nnz()
+      << ", representation=" << representationName(M.representation()) << ")";
+  return os;
+}
+
+template class BasicAdaptiveMatrix<float>;
+template class BasicAdaptiveMatrix<double>;
+template class BasicAdaptiveMatrix<std::int32_t>;
+template class BasicAdaptiveMatrix<std::int64_t>;
+
+template std::ostream &operator<<(std::ostream &os, const BasicAdaptiveMatrix<float> &M);
+template std::ostream &operator<<(std::ostream &os, const BasicAdaptiveMatrix<double> &M);
+template std::ostream &operator<<(std::ostream &os, const BasicAdaptiveMatrix<std::int32_t> &M);
+template std::ostream &operator<<(std::ostream &os, const BasicAdaptiveMatrix<std::int64_t> &M);
@@ -0,0 +1,164 @@
+#ifndef MC458_PROJETO_ADAPTIVEMATRIX_H
+#define MC458_PROJETO_ADAPTIVEMATRIX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <tuple>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "../dense_matrix/DenseMatrix.h"
+#include "../sparse_matrix_csr/SparseMatrixCSR.h"
+#include "../sparse_matrix_hash/SparseMatrixHash.h"
+#include "../sparse_matrix_tree/SparseMatrixTree.h"
+#include "../../parallel/ThreadPool.h"
+
+// Na mesma ordem das alternativas guardadas por BasicAdaptiveMatrix
+enum class MatrixRepresentation { DENSE, HASH, TREE, COMPRESSED };
+
+const char *representationName(MatrixRepresentation representation);
+
+double estimatedProductFill(double densityA, double densityB, int depth);
+
+// Limiares de preenchimento (nnz / (n * m)) que escolhem a representação. Os padrões foram medidos com
+// MC458_Projeto --calibrar (n = 1000); calibrateAdaptivePolicy, do benchmark, mede-os de novo.
+// denseMaxBytes limita a memória da forma densa: acima dele a matriz fica esparsa qualquer que seja o
+// preenchimento (com n = 100000, a forma densa de double ocuparia 80 GB)
+struct AdaptivePolicy {
+  double denseAbove = 0.05; // a partir deste preenchimento (médio, numa soma) a forma densa é usada
+  double sparseBelow = 0.025; // uma matriz densa abaixo deste preenchimento volta à forma comprimida
+  double denseProductAbove = 0.90; // preenchimento estimado do produto a partir do qual ele é calculado denso
+  size_t denseMaxBytes = size_t(1) << 30; // maior n * m * sizeof(T) que as escolhas automáticas tornam densa
+};
+
+// Fachada que guarda a matriz na representação mais adequada ao seu preenchimento e converte entre elas
+// sozinha: densa quando cheia, comprimida (CSR) como resultado de operações esparsas, hash ou árvore
+// quando o chamador as escolhe para inserções. Uma escrita numa matriz comprimida, que é imutável,
+// passa-a para a hash. Instanciada em AdaptiveMatrix.cpp para float, double, int32_t e int64_t;
+// AdaptiveMatrix é a forma com double
+template<typename T>
+class BasicAdaptiveMatrix {
+  using Dense = BasicDenseMatrix<T>;
+  using Hash = BasicSparseMatrixHash<T>;
+  using Tree = BasicSparseMatrixTree<T>;
+  using CSR = BasicSparseMatrixCSR<T>;
+
+  // Árvore dona dos próprios nós; uma cópia reconstrói a árvore em outra arena. Como a densa e a hash,
+  // guarda um fator de escala pendente, que as funções da árvore não conhecem
+  struct OwnedTree {
+    int n, m;
+    std::unique_ptr<typename Tree::NodeArena> arena;
+    typename Tree::TreeNode *root;
+    T scale = T(1);
+
+    OwnedTree(int n, int m, const std::vector<std::tuple<int, int, T> > &sortedEntries);
+
+    OwnedTree(const OwnedTree &other);
+
+    OwnedTree(OwnedTree &&other) noexcept = default;
+
+    OwnedTree &operator=(const OwnedTree &other);
+
+    OwnedTree &operator=(OwnedTree &&other) noexcept = default;
+
+    std::vector<std::tuple<int, int, T> > entries(bool transpose = false) const;
+
+    void materialize();
+  };
+
+  int n, m;
+  AdaptivePolicy policy;
+  std::variant<Dense, Hash, OwnedTree, CSR> storage;
+  size_t denseNonzeros = 0; // não nulos da forma densa, contados na conversão e mantidos por set
+
+  template<typename Storage>
+  BasicAdaptiveMatrix(int n, int m, const AdaptivePolicy &policy, Storage &&storage);
+
+  bool denseFits(int rows, int cols) const;
+
+  void countDenseNonzeros();
+
+  const Dense &denseOf(Dense &scratch) const;
+
+  const CSR &compressedOf(CSR &scratch) const;
+
+  BasicAdaptiveMatrix product(const BasicAdaptiveMatrix &B, ThreadPool *pool) const;
+
+public:
+  using Value = T;
+
+  BasicAdaptiveMatrix(int n, int m, const AdaptivePolicy &policy = {});
+
+  explicit BasicAdaptiveMatrix(Dense A, const AdaptivePolicy &policy = {});
+
+  explicit BasicAdaptiveMatrix(Hash A, const AdaptivePolicy &policy = {});
+
+  explicit BasicAdaptiveMatrix(CSR A, const AdaptivePolicy &policy = {});
+
+  static BasicAdaptiveMatrix fromTriplets(int n, int m, const std::vector<std::tuple<int, int, T> > &entries,
+                                          const AdaptivePolicy &policy = {});
+
+  int rows() const;
+
+  int cols() const;
+
+  size_t nnz() const;
+
+  double density() const;
+
+  MatrixRepresentation representation() const;
+
+  T get(int i, int j) const;
+
+  void getBatch(const std::pair<int, int> *positions, size_t count, T *values) const;
+
+  void set(int i, int j, T value);
+
+  void convertTo(MatrixRepresentation representation);
+
+  void adapt();
+
+  Dense toDense() const;
+
+  CSR toCompressed() const;
+
+  std::vector<std::tuple<int, int, T> > items() const;
+
+  BasicAdaptiveMatrix transpose() const;
+
+  BasicAdaptiveMatrix submatrix(int r0, int r1, int c0, int c1) const;
+
+  BasicAdaptiveMatrix add(const BasicAdaptiveMatrix &B) const;
+
+  BasicAdaptiveMatrix operator+(const BasicAdaptiveMatrix &B) const;
+
+  BasicAdaptiveMatrix scalarMult(T alpha) const;
+
+  BasicAdaptiveMatrix &operator*=(T alpha);
+
+  BasicAdaptiveMatrix mult(const BasicAdaptiveMatrix &B) const;
+
+  BasicAdaptiveMatrix multParallel(const BasicAdaptiveMatrix &B, ThreadPool &pool = ThreadPool::shared()) const;
+
+  BasicAdaptiveMatrix operator*(const BasicAdaptiveMatrix &B) const;
+
+  std::vector<T> multVector(const std::vector<T> &x) const;
+
+  template<typename U>
+  friend std::ostream &operator<<(std::ostream &os, const BasicAdaptiveMatrix<U> &M);
+};
+
+template<typename T>
+std::ostream &operator<<(std::ostream &os, const BasicAdaptiveMatrix<T> &M);
+
+extern template class BasicAdaptiveMatrix<float>;
+extern template class BasicAdaptiveMatrix<double>;
+extern template class BasicAdaptiveMatrix<std::int32_t>;
+extern template class BasicAdaptiveMatrix<std::int64_t>;
+
+using AdaptiveMatrix = BasicAdaptiveMatrix<double>;
+
+#endif //MC458_PROJETO_ADAPTIVEMATRIX_H
@@ -0,0 +1,135 @@
+#ifndef MC458_PROJETO_DENSEEXPRESSION_H
+#define MC458_PROJETO_DENSEEXPRESSION_H
+
+#include <cassert>
+#include <cstddef>
+#include <type_traits>
+
+// Expressões elemento a elemento sobre matrizes densas avaliadas sob demanda: A * alpha + B * beta monta
+// uma árvore de tipos sem calcular nada, e só a atribuição a uma matriz densa percorre a memória, uma única
+// vez, calculando cada elemento da expressão inteira. Cada nó expõe o tipo Value dos elementos, rows(),
+// cols() e at(k), o elemento k na ordem por linhas. Matrizes entram por referência e devem viver até a
+// avaliação: não guarde em auto uma expressão que referencia uma matriz temporária
+template<typename E>
+struct DenseExpression {
+  const E &self() const {
+    return static_cast<const E &>(*this);
+  }
+};
+
+// Matrizes (folhas) são guardadas por referência; nós intermediários, que são pequenos, por valor
+template<typename E>
+using DenseOperand = std::conditional_t<E::IS_LEAF, const E &, const E>;
+
+template<typename L, typename R>
+class DenseSum : public DenseExpression<DenseSum<L, R> > {
+  static_assert(std::is_same_v<typename L::Value, typename R::Value>, "operandos com tipos de valor diferentes");
+
+  DenseOperand<L> left;
+  DenseOperand<R> right;
+
+public:
+  using Value = typename L::Value;
+
+  static constexpr bool IS_LEAF = false;
+
+  DenseSum(const L &left, const R &right) : left(left), right(right) {
+    assert(left.rows() == right.rows() && left.cols() == right.cols());
+  }
+
+  int rows() const {
+    return left.rows();
+  }
+
+  int cols() const {
+    return left.cols();
+  }
+
+  Value at(const size_t k) const {
+    return left.at(k) + right.at(k);
+  }
+};
+
+template<typename L, typename R>
+class DenseDifference : public DenseExpression<DenseDifference<L, R> > {
+  static_assert(std::is_same_v<typename L::Value, typename R::Value>, "operandos com tipos de valor diferentes");
+
+  DenseOperand<L> left;
+  DenseOperand<R> right;
+
+public:
+  using Value = typename L::Value;
+
+  static constexpr bool IS_LEAF = false;
+
+  DenseDifference(const L &left, const R &right) : left(left), right(right) {
+    assert(left.rows() == right.rows() && left.cols() == right.cols());
+  }
+
+  int rows() const {
+    return left.rows();
+  }
+
+  int cols() const {
+    return left.cols();
+  }
+
+  Value at(const size_t k) const {
+    return left.at(k) - right.at(k);
+  }
+};
+
+template<typename E>
+class DenseScaled : public DenseExpression<DenseScaled<E> > {
+public:
+  using Value = typename E::Value;
+
+private:
+  DenseOperand<E> operand;
+  Value alpha;
+
+public:
+  static constexpr bool IS_LEAF = false;
+
+  DenseScaled(const E &operand, const Value alpha) : operand(operand), alpha(alpha) {
+  }
+
+  int rows() const {
+    return operand.rows();
+  }
+
+  int cols() const {
+    return operand.cols();
+  }
+
+  Value at(const size_t k) const {
+    return alpha * operand.at(k);
+  }
+};
+
+template<typename L, typename R>
+DenseSum<L, R> operator+(const DenseExpression<L> &left, const DenseExpression<R> &right) {
+  return DenseSum<L, R>(left.self(), right.self());
+}
+
+template<typename L, typename R>
+DenseDifference<L, R> operator-(const DenseExpression<L> &left, const DenseExpression<R> &right) {
+  return DenseDifference<L, R>(left.self(), right.self());
+}
+
+template<typename E>
+DenseScaled<E> operator*(const DenseExpression<E> &operand, const typename E::Value alpha) {
+  return DenseScaled<E>(operand.self(), alpha);
+}
+
+template<typename E>
+DenseScaled<E> operator*(const typename E::Value alpha, const DenseExpression<E> &operand) {
+  return DenseScaled<E>(operand.self(), alpha);
+}
+
+template<typename E>
+DenseScaled<E> operator-(const DenseExpression<E> &operand) {
+  return DenseScaled<E>(operand.self(), typename E::Value(-1));
+}
+
+#endif //MC458_PROJETO_DENSEEXPRESSION_H
@@ -1,72 +1,570 @@
 #include "DenseMatrix.h"
+#include <algorithm>
+#include <cassert>
 #include <vector>
 
-DenseMatrix::DenseMatrix(const int n, const int m)
-  : n(n), m(m), data(n, std::vector(m, 0.0)) {
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define MC458_X86_DISPATCH 1
+#include <immintrin.h>
+#endif
+
+// Núcleo da multiplicação densa: C[rows x cols] += A[rows x depth] * Bp[depth x cols], com A de passo lda,
+// o painel empacotado de B de passo ldb e C de passo ldc. O painel de B é reutilizado por todas as linhas de A.
+// double e float têm núcleos vetorizados próprios; os tipos inteiros usam o núcleo escalar
+namespace {
+  constexpr int KC = 256;
+  constexpr int NC = 512;
+
+  // Quantas leituras à frente getBatch pede as linhas de cache
+  constexpr size_t PREFETCH_DISTANCE = 16;
+
+  template<typename T>
+  using PanelKernel = void (*)(const T *A, int lda, const T *Bp, int ldb, T *C, int ldc, int rows, int cols,
+                               int depth);
+
+  template<typename T>
+  void panelEdge(const T *A, const int lda, const T *Bp, const int ldb,
+                 T *C, const int ldc, const int i0, const int i1, const int j0, const int j1, const int depth) {
+    for (int i = i0; i < i1; i++) {
+      T *c = C + static_cast<size_t>(i) * ldc;
+      const T *a = A + static_cast<size_t>(i) * lda;
+      for (int k = 0; k < depth; k++) {
+        const T aValue = a[k];
+        const T *b = Bp + static_cast<size_t>(k) * ldb;
+        for (int j = j0; j < j1; j++) {
+          c[j] += aValue * b[j];
+        }
+      }
+    }
+  }
+
+  template<typename T>
+  void panelScalar(const T *A, const int lda, const T *Bp, const int ldb,
+                   T *C, const int ldc, const int rows, const int cols, const int depth) {
+    panelEdge(A, lda, Bp, ldb, C, ldc, 0, rows, 0, cols, depth);
+  }
+
+#ifdef MC458_X86_DISPATCH
+  // Bloco de registradores 4 x 8: oito acumuladores de 4 doubles
+  __attribute__((target("avx2,fma")))
+  void panelAVX2(const double *A, const int lda, const double *Bp, const int ldb,
+                 double *C, const int ldc, const int rows, const int cols, const int depth) {
+    const int rowsMain = rows - rows % 4;
+    const int colsMain = cols - cols % 8;
+
+    for (int i = 0; i < rowsMain; i += 4) {
+      const double *a0 = A + static_cast<size_t>(i) * lda;
+      const double *a1 = a0 + lda, *a2 = a1 + lda, *a3 = a2 + lda;
+      double *c0 = C + static_cast<size_t>(i) * ldc;
+      double *c1 = c0 + ldc, *c2 = c1 + ldc, *c3 = c2 + ldc;
+
+      for (int j = 0; j < colsMain; j += 8) {
+        __m256d c00 = _mm256_loadu_pd(c0 + j), c01 = _mm256_loadu_pd(c0 + j + 4);
+        __m256d c10 = _mm256_loadu_pd(c1 + j), c11 = _mm256_loadu_pd(c1 + j + 4);
+        __m256d c20 = _mm256_loadu_pd(c2 + j), c21 = _mm256_loadu_pd(c2 + j + 4);
+        __m256d c30 = _mm256_loadu_pd(c3 + j), c31 = _mm256_loadu_pd(c3 + j + 4);
+
+        for (int k = 0; k < depth; k++) {
+          const double *b = Bp + static_cast<size_t>(k) * ldb + j;
+          const __m256d b0 = _mm256_loadu_pd(b), b1 = _mm256_loadu_pd(b + 4);
+          __m256d a = _mm256_broadcast_sd(a0 + k);
+          c00 = _mm256_fmadd_pd(a, b0, c00);
+          c01 = _mm256_fmadd_pd(a, b1, c01);
+          a = _mm256_broadcast_sd(a1 + k);
+          c10 = _mm256_fmadd_pd(a, b0, c10);
+          c11 = _mm256_fmadd_pd(a, b1, c11);
+          a = _mm256_broadcast_sd(a2 + k);
+          c20 = _mm256_fmadd_pd(a, b0, c20);
+          c21 = _mm256_fmadd_pd(a, b1, c21);
+          a = _mm256_broadcast_sd(a3 + k);
+          c30 = _mm256_fmadd_pd(a, b0, c30);
+          c31 = _mm256_fmadd_pd(a, b1, c31);
+        }
+
+        _mm256_storeu_pd(c0 + j, c00);
+        _mm256_storeu_pd(c0 + j + 4, c01);
+        _mm256_storeu_pd(c1 + j, c10);
+        _mm256_storeu_pd(c1 + j + 4, c11);
+        _mm256_storeu_pd(c2 + j, c20);
+        _mm256_storeu_pd(c2 + j + 4, c21);
+        _mm256_storeu_pd(c3 + j, c30);
+        _mm256_storeu_pd(c3 + j + 4, c31);
+      }
+    }
+
+    panelEdge(A, lda, Bp, ldb, C, ldc, 0, rowsMain, colsMain, cols, depth);
+    panelEdge(A, lda, Bp, ldb, C, ldc, rowsMain, rows, 0, cols, depth);
+  }
+
+  // Bloco de registradores 4 x 16: oito acumuladores de 8 doubles
+  __attribute__((target("avx512f")))
+  void panelAVX512(const double *A, const int lda, const double *Bp, const int ldb,
+                   double *C, const int ldc, const int rows, const int cols, const int depth) {
+    const int rowsMain = rows - rows % 4;
+    const int colsMain = cols - cols % 16;
+
+    for (int i = 0; i < rowsMain; i += 4) {
+      const double *a0 = A + static_cast<size_t>(i) * lda;
+      const double *a1 = a0 + lda, *a2 = a1 + lda, *a3 = a2 + lda;
+      double *c0 = C + static_cast<size_t>(i) * ldc;
+      double *c1 = c0 + ldc, *c2 = c1 + ldc, *c3 = c2 + ldc;
+
+      for (int j = 0; j < colsMain; j += 16) {
+        __m512d c00 = _mm512_loadu_pd(c0 + j), c01 = _mm512_loadu_pd(c0 + j + 8);
+        __m512d c10 = _mm512_loadu_pd(c1 + j), c11 = _mm512_loadu_pd(c1 + j + 8);
+        __m512d c20 = _mm512_loadu_pd(c2 + j), c21 = _mm512_loadu_pd(c2 + j + 8);
+        __m512d c30 = _mm512_loadu_pd(c3 + j), c31 = _mm512_loadu_pd(c3 + j + 8);
+
+        for (int k = 0; k < depth; k++) {
+          const double *b = Bp + static_cast<size_t>(k) * ldb + j;
+          const __m512d b0 = _mm512_loadu_pd(b), b1 = _mm512_loadu_pd(b + 8);
+          __m512d a = _mm512_set1_pd(a0[k]);
+          c00 = _mm512_fmadd_pd(a, b0, c00);
+          c01 = _mm512_fmadd_pd(a, b1, c01);
+          a = _mm512_set1_pd(a1[k]);
+          c10 = _mm512_fmadd_pd(a, b0, c10);
+          c11 = _mm512_fmadd_pd(a, b1, c11);
+          a = _mm512_set1_pd(a2[k]);
+          c20 = _mm512_fmadd_pd(a, b0, c20);
+          c21 = _mm512_fmadd_pd(a, b1, c21);
+          a = _mm512_set1_pd(a3[k]);
+          c30 = _mm512_fmadd_pd(a, b0, c30);
+          c31 = _mm512_fmadd_pd(a, b1, c31);
+        }
+
+        _mm512_storeu_pd(c0 + j, c00);
+        _mm512_storeu_pd(c0 + j + 8, c01);
+        _mm512_storeu_pd(c1 + j, c10);
+        _mm512_storeu_pd(c1 + j + 8, c11);
+        _mm512_storeu_pd(c2 + j, c20);
+        _mm512_storeu_pd(c2 + j + 8, c21);
+        _mm512_storeu_pd(c3 + j, c30);
+        _mm512_storeu_pd(c3 + j + 8, c31);
+      }
+    }
+
+    panelEdge(A, lda, Bp, ldb, C, ldc, 0, rowsMain, colsMain, cols, depth);
+    panelEdge(A, lda, Bp, ldb, C, ldc, rowsMain, rows, 0, cols, depth);
+  }
+
+  // Bloco de registradores 4 x 16: oito acumuladores de 8 floats
+  __attribute__((target("avx2,fma")))
+  void panelAVX2(const float *A, const int lda, const float *Bp, const int ldb,
+                 float *C, const int ldc, const int rows, const int cols, const int depth) {
+    const int rowsMain = rows - rows % 4;
+    const int colsMain = cols - cols % 16;
+
+    for (int i = 0; i < rowsMain; i += 4) {
+      const float *a0 = A + static_cast<size_t>(i) * lda;
+      const float *a1 = a0 + lda, *a2 = a1 + lda, *a3 = a2 + lda;
+      float *c0 = C + static_cast<size_t>(i) * ldc;
+      float *c1 = c0 + ldc, *c2 = c1 + ldc, *c3 = c2 + ldc;
+
+      for (int j = 0; j < colsMain; j += 16) {
+        __m256 c00 = _mm256_loadu_ps(c0 + j), c01 = _mm256_loadu_ps(c0 + j + 8);
+        __m256 c10 = _mm256_loadu_ps(c1 + j), c11 = _mm256_loadu_ps(c1 + j + 8);
+        __m256 c20 = _mm256_loadu_ps(c2 + j), c21 = _mm256_loadu_ps(c2 + j + 8);
+        __m256 c30 = _mm256_loadu_ps(c3 + j), c31 = _mm256_loadu_ps(c3 + j + 8);
+
+        for (int k = 0; k < depth; k++) {
+          const float *b = Bp + static_cast<size_t>(k) * ldb + j;
+          const __m256 b0 = _mm256_loadu_ps(b), b1 = _mm256_loadu_ps(b + 8);
+          __m256 a = _mm256_broadcast_ss(a0 + k);
+          c00 = _mm256_fmadd_ps(a, b0, c00);
+          c01 = _mm256_fmadd_ps(a, b1, c01);
+          a = _mm256_broadcast_ss(a1 + k);
+          c10 = _mm256_fmadd_ps(a, b0, c10);
+          c11 = _mm256_fmadd_ps(a, b1, c11);
+          a = _mm256_broadcast_ss(a2 + k);
+          c20 = _mm256_fmadd_ps(a, b0, c20);
+          c21 = _mm256_fmadd_ps(a, b1, c21);
+          a = _mm256_broadcast_ss(a3 + k);
+          c30 = _mm256_fmadd_ps(a, b0, c30);
+          c31 = _mm256_fmadd_ps(a, b1, c31);
+        }
+
+        _mm256_storeu_ps(c0 + j, c00);
+        _mm256_storeu_ps(c0 + j + 8, c01);
+        _mm256_storeu_ps(c1 + j, c10);
+        _mm256_storeu_ps(c1 + j + 8, c11);
+        _mm256_storeu_ps(c2 + j, c20);
+        _mm256_storeu_ps(c2 + j + 8, c21);
+        _mm256_storeu_ps(c3 + j, c30);
+        _mm256_storeu_ps(c3 + j + 8, c31);
+      }
+    }
+
+    panelEdge(A, lda, Bp, ldb, C, ldc, 0, rowsMain, colsMain, cols, depth);
+    panelEdge(A, lda, Bp, ldb, C, ldc, rowsMain, rows, 0, cols, depth);
+  }
+
+  // Bloco de registradores 4 x 32: oito acumuladores de 16 floats
+  __attribute__((target("avx512f")))
+  void panelAVX512(const float *A, const int lda, const float *Bp, const int ldb,
+                   float *C, const int ldc, const int rows, const int cols, const int depth) {
+    const int rowsMain = rows - rows % 4;
+    const int colsMain = cols - cols % 32;
+
+    for (int i = 0; i < rowsMain; i += 4) {
+      const float *a0 = A + static_cast<size_t>(i) * lda;
+      const float *a1 = a0 + lda, *a2 = a1 + lda, *a3 = a2 + lda;
+      float *c0 = C + static_cast<size_t>(i) * ldc;
+      float *c1 = c0 + ldc, *c2 = c1 + ldc, *c3 = c2 + ldc;
+
+      for (int j = 0; j < colsMain; j += 32) {
+        __m512 c00 = _mm512_loadu_ps(c0 + j), c01 = _mm512_loadu_ps(c0 + j + 16);
+        __m512 c10 = _mm512_loadu_ps(c1 + j), c11 = _mm512_loadu_ps(c1 + j + 16);
+        __m512 c20 = _mm512_loadu_ps(c2 + j), c21 = _mm512_loadu_ps(c2 + j + 16);
+        __m512 c30 = _mm512_loadu_ps(c3 + j), c31 = _mm512_loadu_ps(c3 + j + 16);
+
+        for (int k = 0; k < depth; k++) {
+          const float *b = Bp + static_cast<size_t>(k) * ldb + j;
+          const __m512 b0 = _mm512_loadu_ps(b), b1 = _mm512_loadu_ps(b + 16);
+          __m512 a = _mm512_set1_ps(a0[k]);
+          c00 = _mm512_fmadd_ps(a, b0, c00);
+          c01 = _mm512_fmadd_ps(a, b1, c01);
+          a = _mm512_set1_ps(a1[k]);
+          c10 = _mm512_fmadd_ps(a, b0, c10);
+          c11 = _mm512_fmadd_ps(a, b1, c11);
+          a = _mm512_set1_ps(a2[k]);
+          c20 = _mm512_fmadd_ps(a, b0, c20);
+          c21 = _mm512_fmadd_ps(a, b1, c21);
+          a = _mm512_set1_ps(a3[k]);
+          c30 = _mm512_fmadd_ps(a, b0, c30);
+          c31 = _mm512_fmadd_ps(a, b1, c31);
+        }
+
+        _mm512_storeu_ps(c0 + j, c00);
+        _mm512_storeu_ps(c0 + j + 16, c01);
+        _mm512_storeu_ps(c1 + j, c10);
+        _mm512_storeu_ps(c1 + j + 16, c11);
+        _mm512_storeu_ps(c2 + j, c20);
+        _mm512_storeu_ps(c2 + j + 16, c21);
+        _mm512_storeu_ps(c3 + j, c30);
+        _mm512_storeu_ps(c3 + j + 16, c31);
+      }
+    }
+
+    panelEdge(A, lda, Bp, ldb, C, ldc, 0, rowsMain, colsMain, cols, depth);
+    panelEdge(A, lda, Bp, ldb, C, ldc, rowsMain, rows, 0, cols, depth);
+  }
+#endif
+
+  constexpr size_t PARALLEL_MIN_ELEMENTS = size_t{1} << 18;
+  constexpr int TRANSPOSE_TILE = 32;
+
+  /// @brief Divide [0, total) em faixas contíguas, múltiplas de grain, executadas pelo conjunto compartilhado.
+  ///        Operações com menos de PARALLEL_MIN_ELEMENTS elementos rodam na thread atual
+  /// @param total tamanho do intervalo
+  /// @param grain granularidade das faixas
+  /// @param work número de elementos processados, usado para decidir se vale paralelizar
+  /// @param body função chamada como body(início, fim)
+  template<typename Body>
+  void parallelRanges(const size_t total, const size_t grain, const size_t work, Body &&body) {
+    ThreadPool &pool = ThreadPool::shared();
+    if (work < PARALLEL_MIN_ELEMENTS || pool.size() == 1) {
+      body(size_t{0}, total);
+      return;
+    }
+
+    const int chunks = pool.size();
+    const size_t step = ((total + chunks - 1) / chunks + grain - 1) / grain * grain;
+    pool.run(chunks, [&](const int c) {
+      const size_t begin = std::min(total, c * step);
+      const size_t end = std::min(total, begin + step);
+      if (begin < end) {
+        body(begin, end);
+      }
+    });
+  }
+
+  /// @brief Escolhe, uma única vez, o núcleo mais largo suportado pelo processador em tempo de execução
+  template<typename T>
+  PanelKernel<T> selectPanelKernel() {
+    return panelScalar<T>;
+  }
+
+  template<>
+  PanelKernel<double> selectPanelKernel<double>() {
+#ifdef MC458_X86_DISPATCH
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+      return panelAVX512;
+    }
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+      return panelAVX2;
+    }
+#endif
+    return panelScalar<double>;
+  }
+
+  template<>
+  PanelKernel<float> selectPanelKernel<float>() {
+#ifdef MC458_X86_DISPATCH
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+      return panelAVX512;
+    }
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+      return panelAVX2;
+    }
+#endif
+    return panelScalar<float>;
+  }
 }
 
-void DenseMatrix::set(const int i, const int j, const double value) {
-  data[i][j] = value;
+template<typename T>
+BasicDenseMatrix<T>::BasicDenseMatrix(const int n, const int m, Uninitialized)
+  : n(n), m(m), data(std::make_shared<Storage>(static_cast<size_t>(n) * m)) {
 }
 
-double DenseMatrix::get(const int i, const int j) const {
-  return data[i][j];
+template<typename T>
+BasicDenseMatrix<T>::BasicDenseMatrix(const int n, const int m)
+  : BasicDenseMatrix(n, m, Uninitialized{}) {
+  T *out = data->data();
+  forEachRange([&](const size_t begin, const size_t end) {
+    std::fill(out + begin, out + end, T{});
+  });
 }
 
-DenseMatrix DenseMatrix::add(const DenseMatrix &B) const {
-  DenseMatrix C(n, m);
-  for (int i = 0; i < n; i++) {
-    for (int j = 0; j < m; j++) {
-      C.data[i][j] = data[i][j] + B.data[i][j];
+template<typename T>
+int BasicDenseMatrix<T>::rows() const {
+  return n;
+}
+
+template<typename T>
+int BasicDenseMatrix<T>::cols() const {
+  return m;
+}
+
+template<typename T>
+void BasicDenseMatrix<T>::set(const int i, const int j, const T value) {
+  mutableData()[index(i, j)] = value;
+}
+
+template<typename T>
+T BasicDenseMatrix<T>::get(const int i, const int j) const {
+  return scale * (*data)[index(i, j)];
+}
+
+/// @brief Lê count posições aleatórias pedindo ao processador a linha de cache de cada uma PREFETCH_DISTANCE
+///        leituras antes de usá-la, para que as faltas de cache se sobreponham
+/// @param values recebe os count valores lidos, na ordem das posições
+template<typename T>
+void BasicDenseMatrix<T>::getBatch(const std::pair<int, int> *positions, const size_t count, T *values) const {
+  for (size_t t = 0; t < std::min(count, PREFETCH_DISTANCE); t++) {
+    __builtin_prefetch(&(*data)[index(positions[t].first, positions[t].second)]);
+  }
+  for (size_t t = 0; t < count; t++) {
+    if (t + PREFETCH_DISTANCE < count) {
+      const auto &ahead = positions[t + PREFETCH_DISTANCE];
+      __builtin_prefetch(&(*data)[index(ahead.first, ahead.second)]);
     }
+    values[t] = scale * (*data)[index(positions[t].first, positions[t].second)];
   }
+}
 
-  return C;
+/// @brief Fator pendente que multiplica todos os elementos guardados
+template<typename T>
+T BasicDenseMatrix<T>::scaleFactor() const {
+  return scale;
+}
+
+/// @brief Aplica o fator pendente aos elementos guardados, numa passada, e volta o fator a 1. Se outra matriz
+///        compartilha o armazenamento, os elementos multiplicados vão para um novo, na mesma passada
+template<typename T>
+void BasicDenseMatrix<T>::materialize() {
+  if (scale == T(1)) {
+    return;
+  }
+  const T *source = data->data();
+  std::shared_ptr<Storage> target = data;
+  if (data.use_count() > 1) {
+    target = std::make_shared<Storage>(data->size());
+  }
+  T *out = target->data();
+  const T alpha = scale;
+  forEachRange([&](const size_t begin, const size_t end) {
+    for (size_t p = begin; p < end; p++) {
+      out[p] = alpha * source[p];
+    }
+  });
+  data = std::move(target);
+  scale = T(1);
 }
 
-DenseMatrix DenseMatrix::operator+(const DenseMatrix &B) const {
-  return add(B);
+/// @brief Elementos para escrita, com o fator pendente aplicado e sem outra matriz que os compartilhe
+template<typename T>
+T *BasicDenseMatrix<T>::mutableData() {
+  materialize();
+  if (data.use_count() > 1) {
+    data = std::make_shared<Storage>(*data);
+  }
+  return data->data();
+}
+
+/// @brief Linha para escrita; aplica antes o fator pendente
+template<typename T>
+T *BasicDenseMatrix<T>::rowData(const int i) {
+  return mutableData() + index(i, 0);
 }
 
-DenseMatrix DenseMatrix::scalarMult(const double alpha) const {
-  DenseMatrix C(n, m);
+/// @brief Linha guardada, sem o fator pendente: o valor lógico é scaleFactor() vezes o elemento
+template<typename T>
+const T *BasicDenseMatrix<T>::rowData(const int i) const {
+  return data->data() + index(i, 0);
+}
+
+template<typename T>
+std::vector<T> BasicDenseMatrix<T>::row(const int i) const {
+  assert(0 <= i && i < n);
+  std::vector<T> values(m);
+  const T *source = data->data() + index(i, 0);
+  for (int j = 0; j < m; j++) {
+    values[j] = scale * source[j];
+  }
+  return values;
+}
+
+template<typename T>
+std::vector<T> BasicDenseMatrix<T>::col(const int j) const {
+  assert(0 <= j && j < m);
+  std::vector<T> values(n);
   for (int i = 0; i < n; i++) {
-    for (int j = 0; j < m; j++) {
-      C.data[i][j] = alpha * data[i][j];
-    }
+    values[i] = scale * (*data)[index(i, j)];
   }
+  return values;
+}
+
+/// @brief Cópia do bloco [r0, r1) x [c0, c1), linha a linha, com o mesmo fator pendente
+template<typename T>
+BasicDenseMatrix<T> BasicDenseMatrix<T>::submatrix(const int r0, const int r1, const int c0, const int c1) const {
+  assert(0 <= r0 && r0 <= r1 && r1 <= n && 0 <= c0 && c0 <= c1 && c1 <= m);
 
+  BasicDenseMatrix C(r1 - r0, c1 - c0, Uninitialized{});
+  C.scale = scale;
+  for (int i = r0; i < r1; i++) {
+    const T *source = data->data() + index(i, c0);
+    std::copy(source, source + (c1 - c0), C.data->begin() + C.index(i - r0, 0));
+  }
   return C;
 }
 
-DenseMatrix DenseMatrix::operator*(const double alpha) const {
-  return scalarMult(alpha);
+template<typename T>
+void BasicDenseMatrix<T>::forEachRange(const std::function<void(size_t, size_t)> &body) const {
+  const size_t size = static_cast<size_t>(n) * m;
+  parallelRanges(size, 8, size, body);
 }
 
-DenseMatrix DenseMatrix::mult(const DenseMatrix &B) const {
-  DenseMatrix C(n, B.m);
-  for (int i = 0; i < n; i++) {
-    for (int j = 0; j < B.m; j++) {
-      for (int k = 0; k < m; k++) {
-        C.data[i][j] += data[i][k] * B.data[k][j];
+template<typename T>
+BasicDenseMatrix<T> BasicDenseMatrix<T>::add(const BasicDenseMatrix &B) const {
+  return BasicDenseMatrix(*this + B);
+}
+
+/// @brief Cópia em O(1): compartilha o armazenamento e multiplica o fator pendente por alpha
+template<typename T>
+BasicDenseMatrix<T> BasicDenseMatrix<T>::scalarMult(const T alpha) const {
+  BasicDenseMatrix C = *this;
+  C.scale *= alpha;
+  return C;
+}
+
+/// @brief Multiplicação por escalar em O(1), acumulada no fator pendente
+template<typename T>
+BasicDenseMatrix<T> &BasicDenseMatrix<T>::operator*=(const T alpha) {
+  scale *= alpha;
+  return *this;
+}
+
+/// Multiplicação em blocos das linhas [rowBegin, rowEnd) de C: para cada painel KC x NC de B (empacotado
+/// de forma contígua), as linhas de A passam pelo núcleo vetorizado selecionado em tempo de execução.
+template<typename T>
+void BasicDenseMatrix<T>::multRows(const BasicDenseMatrix &B, BasicDenseMatrix &C, const int rowBegin,
+                                   const int rowEnd) const {
+  static const PanelKernel<T> kernel = selectPanelKernel<T>();
+
+  std::vector<T> packed(static_cast<size_t>(KC) * NC);
+
+  for (int jj = 0; jj < B.m; jj += NC) {
+    const int cols = std::min(NC, B.m - jj);
+
+    for (int kk = 0; kk < m; kk += KC) {
+      const int depth = std::min(KC, m - kk);
+
+      for (int k = 0; k < depth; k++) {
+        const T *source = B.data->data() + B.index(kk + k, jj);
+        std::copy(source, source + cols, packed.begin() + static_cast<size_t>(k) * cols);
       }
+
+      kernel(data->data() + index(rowBegin, kk), m, packed.data(), cols,
+             C.data->data() + C.index(rowBegin, jj), C.m, rowEnd - rowBegin, cols, depth);
     }
   }
+}
+
+template<typename T>
+BasicDenseMatrix<T> BasicDenseMatrix<T>::mult(const BasicDenseMatrix &B) const {
+  assert(m == B.n);
+
+  BasicDenseMatrix C(n, B.m);
+  multRows(B, C, 0, n);
+  C.scale = scale * B.scale;
+  return C;
+}
+
+/// Multiplicação em paralelo: cada tarefa calcula uma faixa de linhas de C com seu próprio painel de B.
+template<typename T>
+BasicDenseMatrix<T> BasicDenseMatrix<T>::multParallel(const BasicDenseMatrix &B, ThreadPool &pool) const {
+  assert(m == B.n);
+
+  BasicDenseMatrix C(n, B.m);
+  const int chunks = std::max(1, std::min(pool.size() * 2, n / 4));
+  const int rowsPerChunk = ((n + chunks - 1) / chunks + 3) / 4 * 4;
+
+  pool.run(chunks, [&](const int c) {
+    const int rowBegin = std::min(n, c * rowsPerChunk);
+    const int rowEnd = std::min(n, rowBegin + rowsPerChunk);
+    if (rowBegin < rowEnd) {
+      multRows(B, C, rowBegin, rowEnd);
+    }
+  });
+  C.scale = scale * B.scale;
 
   return C;
 }
 
-DenseMatrix DenseMatrix::operator*(const DenseMatrix &B) const {
+template<typename T>
+BasicDenseMatrix<T> BasicDenseMatrix<T>::operator*(const BasicDenseMatrix &B) const {
   return mult(B);
 }
 
-DenseMatrix DenseMatrix::transpose() const {
-  DenseMatrix C(m, n);
-  for (int i = 0; i < n; i++) {
-    for (int j = 0; j < m; j++) {
-      C.data[j][i] = data[i][j];
+/// Transposta em blocos TRANSPOSE_TILE x TRANSPOSE_TILE: cada bloco é lido por linhas e escrito por linhas
+/// em C, e as threads dividem as linhas de C, então nenhuma linha de cache é escrita por duas threads.
+template<typename T>
+BasicDenseMatrix<T> BasicDenseMatrix<T>::transpose() const {
+  BasicDenseMatrix C(m, n, Uninitialized{});
+  C.scale = scale;
+  parallelRanges(m, TRANSPOSE_TILE, data->size(), [&](const size_t begin, const size_t end) {
+    for (int jj = static_cast<int>(begin); jj < static_cast<int>(end); jj += TRANSPOSE_TILE) {
+      const int jEnd = std::min(static_cast<int>(end), jj + TRANSPOSE_TILE);
+
+      for (int ii = 0; ii < n; ii += TRANSPOSE_TILE) {
+        const int iEnd = std::min(n, ii + TRANSPOSE_TILE);
+
+        for (int j = jj; j < jEnd; j++) {
+          T *__restrict c = C.data->data() + C.index(j, 0);
+          for (int i = ii; i < iEnd; i++) {
+            c[i] = (*data)[index(i, j)];
+          }
+        }
+      }
     }
-  }
+  });
 
   return C;
 }
+
+template class BasicDenseMatrix<float>;
+template class BasicDenseMatrix<double>;
+template class BasicDenseMatrix<std::int32_t>;
+template class BasicDenseMatrix<std::int64_t>;
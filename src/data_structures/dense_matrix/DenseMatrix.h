@@ -1,31 +1,193 @@
 #ifndef MC458_PROJETO_DENSEMATRIX_H
 #define MC458_PROJETO_DENSEMATRIX_H
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
-class DenseMatrix {
+#include "../../parallel/ThreadPool.h"
+#include "DenseExpression.h"
+
+// Alocador que não zera elementos construídos sem argumentos, para que o resultado de uma operação
+// seja escrito uma única vez (e pela thread que vai usá-lo) em vez de ser zerado antes
+template<typename T>
+struct DefaultInitAllocator : std::allocator<T> {
+  template<typename U>
+  struct rebind {
+    using other = DefaultInitAllocator<U>;
+  };
+
+  using std::allocator<T>::allocator;
+
+  template<typename U>
+  void construct(U *p) {
+    ::new(static_cast<void *>(p)) U;
+  }
+
+  template<typename U, typename... Args>
+  void construct(U *p, Args &&... args) {
+    ::new(static_cast<void *>(p)) U(std::forward<Args>(args)...);
+  }
+};
+
+// Matriz densa em ordem por linhas com elementos do tipo T. As definições ficam em DenseMatrix.cpp,
+// instanciadas para float, double, int32_t e int64_t; DenseMatrix é a forma com double.
+// A multiplicação por escalar é O(1): o fator fica pendente em scale e é aplicado por quem lê os elementos
+// (get, at, produtos) ou, de uma vez, antes da primeira escrita. Como na hash, cópias compartilham o
+// armazenamento, que só é copiado quando uma delas vai escrever
+template<typename T>
+class BasicDenseMatrix : public DenseExpression<BasicDenseMatrix<T> > {
+  using Storage = std::vector<T, DefaultInitAllocator<T> >;
+
+  struct Uninitialized {
+  };
+
   int n, m;
-  std::vector<std::vector<double> > data;
+  T scale = T(1);
+  std::shared_ptr<Storage> data;
+
+  BasicDenseMatrix(int n, int m, Uninitialized);
+
+  T *mutableData();
+
+  size_t index(int i, int j) const {
+    return static_cast<size_t>(i) * m + j;
+  }
+
+  void multRows(const BasicDenseMatrix &B, BasicDenseMatrix &C, int rowBegin, int rowEnd) const;
+
+  void forEachRange(const std::function<void(size_t, size_t)> &body) const;
+
+  template<typename E>
+  void assign(const E &expression);
 
 public:
-  DenseMatrix(int n, int m);
+  using Value = T;
+
+  static constexpr bool IS_LEAF = true;
+
+  BasicDenseMatrix(int n, int m);
+
+  template<typename E>
+  BasicDenseMatrix(const DenseExpression<E> &expression);
+
+  template<typename E>
+  BasicDenseMatrix &operator=(const DenseExpression<E> &expression);
+
+  template<typename E>
+  BasicDenseMatrix &operator+=(const DenseExpression<E> &expression);
 
-  void set(int i, int j, double value);
+  template<typename E>
+  BasicDenseMatrix &operator-=(const DenseExpression<E> &expression);
 
-  double get(int i, int j) const;
+  BasicDenseMatrix &operator*=(T alpha);
 
-  DenseMatrix add(const DenseMatrix &B) const;
+  int rows() const;
 
-  DenseMatrix operator+(const DenseMatrix &B) const;
+  int cols() const;
 
-  DenseMatrix scalarMult(double alpha) const;
+  void set(int i, int j, T value);
 
-  DenseMatrix operator*(double alpha) const;
+  T get(int i, int j) const;
 
-  DenseMatrix mult(const DenseMatrix &B) const;
+  void getBatch(const std::pair<int, int> *positions, size_t count, T *values) const;
 
-  DenseMatrix operator*(const DenseMatrix &B) const;
+  T scaleFactor() const;
 
-  DenseMatrix transpose() const;
+  void materialize();
+
+  T *rowData(int i);
+
+  const T *rowData(int i) const;
+
+  T at(size_t k) const {
+    return scale * (*data)[k];
+  }
+
+  std::vector<T> row(int i) const;
+
+  std::vector<T> col(int j) const;
+
+  BasicDenseMatrix submatrix(int r0, int r1, int c0, int c1) const;
+
+  BasicDenseMatrix add(const BasicDenseMatrix &B) const;
+
+  BasicDenseMatrix scalarMult(T alpha) const;
+
+  BasicDenseMatrix mult(const BasicDenseMatrix &B) const;
+
+  BasicDenseMatrix multParallel(const BasicDenseMatrix &B, ThreadPool &pool = ThreadPool::shared()) const;
+
+  BasicDenseMatrix operator*(const BasicDenseMatrix &B) const;
+
+  BasicDenseMatrix transpose() const;
 };
 
+/// @brief Avalia a expressão numa matriz nova, numa única passada sobre a memória
+template<typename T>
+template<typename E>
+BasicDenseMatrix<T>::BasicDenseMatrix(const DenseExpression<E> &expression)
+  : BasicDenseMatrix(expression.self().rows(), expression.self().cols(), Uninitialized{}) {
+  assign(expression.self());
+}
+
+/// @brief Avalia a expressão sobre o armazenamento atual quando as dimensões coincidem. A matriz pode
+///        aparecer na própria expressão (A = A * alpha + B): cada elemento só depende da mesma posição
+template<typename T>
+template<typename E>
+BasicDenseMatrix<T> &BasicDenseMatrix<T>::operator=(const DenseExpression<E> &expression) {
+  const E &e = expression.self();
+  n = e.rows();
+  m = e.cols();
+  assign(e);
+  return *this;
+}
+
+template<typename T>
+template<typename E>
+BasicDenseMatrix<T> &BasicDenseMatrix<T>::operator+=(const DenseExpression<E> &expression) {
+  assign(*this + expression.self());
+  return *this;
+}
+
+template<typename T>
+template<typename E>
+BasicDenseMatrix<T> &BasicDenseMatrix<T>::operator-=(const DenseExpression<E> &expression) {
+  assign(*this - expression.self());
+  return *this;
+}
+
+/// @brief Escreve a expressão no armazenamento atual se ele tem o tamanho certo e não é compartilhado; senão
+///        num novo, que só substitui o atual depois da avaliação, já que a expressão pode ler a própria matriz
+template<typename T>
+template<typename E>
+void BasicDenseMatrix<T>::assign(const E &expression) {
+  static_assert(std::is_same_v<typename E::Value, T>, "expressao com outro tipo de valor");
+  assert(expression.rows() == n && expression.cols() == m);
+  std::shared_ptr<Storage> target = data;
+  if (!target || target.use_count() > 1 || target->size() != static_cast<size_t>(n) * m) {
+    target = std::make_shared<Storage>(static_cast<size_t>(n) * m);
+  }
+  T *out = target->data();
+  forEachRange([&](const size_t begin, const size_t end) {
+    for (size_t p = begin; p < end; p++) {
+      out[p] = expression.at(p);
+    }
+  });
+  data = std::move(target);
+  scale = T(1);
+}
+
+extern template class BasicDenseMatrix<float>;
+extern template class BasicDenseMatrix<double>;
+extern template class BasicDenseMatrix<std::int32_t>;
+extern template class BasicDenseMatrix<std::int64_t>;
+
+using DenseMatrix = BasicDenseMatrix<double>;
+
 #endif //MC458_PROJETO_DENSEMATRIX_H
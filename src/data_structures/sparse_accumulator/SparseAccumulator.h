@@ -0,0 +1,59 @@
+#ifndef MC458_PROJETO_SPARSEACCUMULATOR_H
+#define MC458_PROJETO_SPARSEACCUMULATOR_H
+
+#include <algorithm>
+#include <climits>
+#include <vector>
+
+// Acumulador esparso (SPA) usado na multiplicação linha a linha de Gustavson:
+// um vetor denso de valores, um marcador de "geração" por coluna e a lista das colunas tocadas na linha atual.
+// Cada produto parcial custa O(1) sem hashing, e a linha pronta é emitida de uma só vez por flush.
+template<typename T>
+class SparseAccumulator {
+  std::vector<T> values;
+  std::vector<int> marker;
+  std::vector<int> touched;
+  int generation = 0;
+
+public:
+  explicit SparseAccumulator(const int size)
+    : values(size), marker(size, -1) {
+  }
+
+  void add(const int j, const T value) {
+    if (marker[j] != generation) {
+      marker[j] = generation;
+      values[j] = value;
+      touched.push_back(j);
+    } else {
+      values[j] += value;
+    }
+  }
+
+  size_t size() const {
+    return touched.size();
+  }
+
+  /// @brief Emite (coluna, valor) de cada posição não nula da linha acumulada e prepara o acumulador para a próxima
+  /// @param sorted se verdadeiro, as colunas são emitidas em ordem crescente
+  /// @param emit função chamada como emit(coluna, valor)
+  template<typename Emit>
+  void flush(const bool sorted, Emit &&emit) {
+    if (sorted) {
+      std::sort(touched.begin(), touched.end());
+    }
+    for (const int j: touched) {
+      if (values[j] != T{}) {
+        emit(j, values[j]);
+      }
+    }
+    touched.clear();
+
+    if (++generation == INT_MAX) {
+      std::fill(marker.begin(), marker.end(), -1);
+      generation = 0;
+    }
+  }
+};
+
+#endif //MC458_PROJETO_SPARSEACCUMULATOR_H
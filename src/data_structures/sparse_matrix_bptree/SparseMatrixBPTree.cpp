@@ -0,0 +1,670 @@
+#include "SparseMatrixBPTree.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <numeric>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define MC458_X86_DISPATCH 1
+#include <immintrin.h>
+#endif
+
+// Busca dentro de um nó: conta as chaves menores ou iguais à procurada, que é o filho a seguir num nó interno
+// e a posição logo após a chave numa folha. As chaves usadas cabem em 63 bits, então a comparação com sinal do
+// SIMD coincide com a sem sinal, e as posições vazias (NO_KEY) nunca são contadas
+namespace {
+  constexpr std::uint64_t NO_KEY = static_cast<std::uint64_t>(INT64_MAX);
+
+  using KeyCounter = int (*)(const std::uint64_t *keys, std::uint64_t key);
+
+  template<int KEYS>
+  int countNotAboveScalar(const std::uint64_t *keys, const std::uint64_t key) {
+    int count = 0;
+    for (int s = 0; s < KEYS; s++) {
+      count += keys[s] <= key;
+    }
+    return count;
+  }
+
+#ifdef MC458_X86_DISPATCH
+  // Quatro chaves por comparação; cada chave maior soma 1 (a comparação devolve -1) ao acumulador
+  template<int KEYS>
+  __attribute__((target("avx2")))
+  int countNotAboveAVX2(const std::uint64_t *keys, const std::uint64_t key) {
+    const __m256i target = _mm256_set1_epi64x(static_cast<long long>(key));
+    __m256i above = _mm256_setzero_si256();
+    for (int s = 0; s < KEYS; s += 4) {
+      const __m256i block = _mm256_load_si256(reinterpret_cast<const __m256i *>(keys + s));
+      above = _mm256_sub_epi64(above, _mm256_cmpgt_epi64(block, target));
+    }
+    const __m128i sum = _mm_add_epi64(_mm256_castsi256_si128(above), _mm256_extracti128_si256(above, 1));
+    return KEYS - static_cast<int>(_mm_cvtsi128_si64(sum) + _mm_extract_epi64(sum, 1));
+  }
+
+  // Oito chaves por comparação, contadas pela máscara de resultado
+  template<int KEYS>
+  __attribute__((target("avx512f,popcnt")))
+  int countNotAboveAVX512(const std::uint64_t *keys, const std::uint64_t key) {
+    const __m512i target = _mm512_set1_epi64(static_cast<long long>(key));
+    int above = 0;
+    for (int s = 0; s < KEYS; s += 8) {
+      above += __builtin_popcount(_mm512_cmpgt_epi64_mask(_mm512_load_si512(keys + s), target));
+    }
+    return KEYS - above;
+  }
+#endif
+
+  /// @brief Escolhe, uma única vez, a comparação mais larga suportada pelo processador em tempo de execução
+  template<int KEYS>
+  KeyCounter selectKeyCounter() {
+#ifdef MC458_X86_DISPATCH
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+      return countNotAboveAVX512<KEYS>;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+      return countNotAboveAVX2<KEYS>;
+    }
+#endif
+    return countNotAboveScalar<KEYS>;
+  }
+
+  template<int KEYS>
+  int countNotAbove(const std::uint64_t *keys, const std::uint64_t key) {
+    static const KeyCounter counter = selectKeyCounter<KEYS>();
+    return counter(keys, key);
+  }
+
+  int keyRow(const std::uint64_t key) {
+    return static_cast<int>(key >> 32);
+  }
+
+  int keyColumn(const std::uint64_t key) {
+    return static_cast<int>(key & 0xFFFFFFFFu);
+  }
+
+  /// @brief Ordena pares (chave, valor) pela chave; com chaves repetidas fica o último valor dado
+  template<typename T>
+  void sortKeepingLast(std::vector<std::pair<std::uint64_t, T> > &entries) {
+    std::stable_sort(entries.begin(), entries.end(), [](const auto &x, const auto &y) {
+      return x.first < y.first;
+    });
+
+    size_t last = 0;
+    for (size_t p = 0; p < entries.size(); p++) {
+      if (last > 0 && entries[last - 1].first == entries[p].first) {
+        entries[last - 1] = entries[p];
+      } else {
+        entries[last++] = entries[p];
+      }
+    }
+    entries.resize(last);
+  }
+}
+
+template<typename T>
+BasicSparseMatrixBPTree<T>::Leaf::Leaf() : values{}, count(0), next(-1) {
+  std::fill(keys, keys + NODE_KEYS, NO_KEY);
+}
+
+template<typename T>
+BasicSparseMatrixBPTree<T>::Inner::Inner() : children{}, count(0) {
+  std::fill(keys, keys + NODE_KEYS, NO_KEY);
+}
+
+// Constrói a árvore a partir de chaves crescentes: enche as folhas na ordem e depois monta cada nível interno
+// agrupando até NODE_KEYS + 1 nós do nível de baixo, em O(k)
+template<typename T>
+class BasicSparseMatrixBPTree<T>::Builder {
+  BasicSparseMatrixBPTree &M;
+
+public:
+  explicit Builder(BasicSparseMatrixBPTree &M) : M(M) {
+    M.inners.clear();
+    M.leaves.assign(1, Leaf());
+    M.height = 0;
+    M.root = 0;
+    M.elements = 0;
+  }
+
+  void append(const std::uint64_t key, const T value) {
+    if (M.leaves.back().count == NODE_KEYS) {
+      M.leaves.back().next = static_cast<int>(M.leaves.size());
+      M.leaves.emplace_back();
+    }
+    Leaf &leaf = M.leaves.back();
+    assert(leaf.count == 0 || leaf.keys[leaf.count - 1] < key);
+    leaf.keys[leaf.count] = key;
+    leaf.values[leaf.count++] = value;
+    M.elements++;
+  }
+
+  void finish() {
+    std::vector<int> level(M.leaves.size());
+    std::iota(level.begin(), level.end(), 0);
+    std::vector<std::uint64_t> firstKeys(level.size());
+    for (size_t l = 0; l < level.size(); l++) {
+      firstKeys[l] = M.leaves[l].keys[0];
+    }
+
+    while (level.size() > 1) {
+      std::vector<int> parents;
+      std::vector<std::uint64_t> parentKeys;
+      for (size_t begin = 0; begin < level.size(); begin += NODE_KEYS + 1) {
+        const size_t end = std::min(level.size(), begin + NODE_KEYS + 1);
+        parents.push_back(static_cast<int>(M.inners.size()));
+        parentKeys.push_back(firstKeys[begin]);
+
+        Inner &inner = M.inners.emplace_back();
+        for (size_t c = begin; c < end; c++) {
+          inner.children[c - begin] = level[c];
+          if (c > begin) {
+            inner.keys[c - begin - 1] = firstKeys[c];
+          }
+        }
+        inner.count = static_cast<int>(end - begin - 1);
+      }
+      level.swap(parents);
+      firstKeys.swap(parentKeys);
+      M.height++;
+    }
+    assert(M.height <= MAX_HEIGHT);
+
+    M.root = level[0];
+  }
+};
+
+template<typename T>
+BasicSparseMatrixBPTree<T>::BasicSparseMatrixBPTree(const int n, const int m)
+  : n(n), m(m), height(0), root(0), elements(0), leaves(1) {
+}
+
+/// @brief Constrói em O(k) a partir de triplas ordenadas por (linha, coluna), sem posições repetidas;
+///        valores zero são ignorados
+template<typename T>
+BasicSparseMatrixBPTree<T> BasicSparseMatrixBPTree<T>::fromSorted(
+  const int n, const int m, const std::vector<std::tuple<int, int, T> > &entries) {
+  BasicSparseMatrixBPTree C(n, m);
+  Builder builder(C);
+  for (const auto &[i, j, value]: entries) {
+    assert(0 <= i && i < n && 0 <= j && j < m);
+    if (value != T{}) {
+      builder.append(pack(i, j), value);
+    }
+  }
+  builder.finish();
+  return C;
+}
+
+/// @brief Constrói a partir de triplas em qualquer ordem, em O(k log k). Como em
+///        SparseMatrixTree::buildFromUnsorted, de posições repetidas fica o último valor
+template<typename T>
+BasicSparseMatrixBPTree<T> BasicSparseMatrixBPTree<T>::fromTriplets(const int n, const int m,
+                                                                  std::vector<std::tuple<int, int, T> > entries) {
+  std::vector<std::pair<std::uint64_t, T> > keyed;
+  keyed.reserve(entries.size());
+  for (const auto &[i, j, value]: entries) {
+    assert(0 <= i && i < n && 0 <= j && j < m);
+    keyed.emplace_back(pack(i, j), value);
+  }
+  entries.clear();
+  entries.shrink_to_fit();
+  sortKeepingLast(keyed);
+
+  BasicSparseMatrixBPTree C(n, m);
+  Builder builder(C);
+  for (const auto &[key, value]: keyed) {
+    if (value != T{}) {
+      builder.append(key, value);
+    }
+  }
+  builder.finish();
+  return C;
+}
+
+/// @brief Constrói a partir de uma matriz comprimida; só ordena se as linhas não estiverem em ordem de coluna
+template<typename T>
+BasicSparseMatrixBPTree<T> BasicSparseMatrixBPTree<T>::fromCompressed(const BasicSparseMatrixCSR<T> &A) {
+  const BasicSparseMatrixCSR<T> R = A.isColumnMajor() ? A.toRowMajor() : A;
+
+  std::vector<std::pair<std::uint64_t, T> > keyed;
+  keyed.reserve(R.nnz());
+  for (int i = 0; i < R.rows(); i++) {
+    const auto line = R.row(i);
+    for (int p = 0; p < line.size; p++) {
+      if (line.value[p] != T{}) {
+        keyed.emplace_back(pack(i, line.index[p]), line.value[p]);
+      }
+    }
+  }
+  if (!std::is_sorted(keyed.begin(), keyed.end(), [](const auto &x, const auto &y) { return x.first < y.first; })) {
+    sortKeepingLast(keyed);
+  }
+
+  BasicSparseMatrixBPTree C(R.rows(), R.cols());
+  Builder builder(C);
+  for (const auto &[key, value]: keyed) {
+    builder.append(key, value);
+  }
+  builder.finish();
+  return C;
+}
+
+template<typename T>
+int BasicSparseMatrixBPTree<T>::rows() const {
+  return n;
+}
+
+template<typename T>
+int BasicSparseMatrixBPTree<T>::cols() const {
+  return m;
+}
+
+template<typename T>
+size_t BasicSparseMatrixBPTree<T>::nnz() const {
+  return elements;
+}
+
+/// @brief Número de nós visitados por uma busca (níveis internos mais o das folhas)
+template<typename T>
+int BasicSparseMatrixBPTree<T>::depth() const {
+  return height + 1;
+}
+
+/// @brief Fator pendente que multiplica todos os valores guardados
+template<typename T>
+T BasicSparseMatrixBPTree<T>::scaleFactor() const {
+  return scale;
+}
+
+/// @brief Desce da raiz até a folha onde a chave está ou seria inserida
+/// @param path se não nulo, recebe o nó interno e o filho escolhido em cada nível
+/// @return índice da folha
+template<typename T>
+int BasicSparseMatrixBPTree<T>::findLeaf(const std::uint64_t key, Path *path) const {
+  int node = root;
+  for (int level = 0; level < height; level++) {
+    const Inner &inner = inners[node];
+    const int slot = countNotAbove<NODE_KEYS>(inner.keys, key);
+    if (path) {
+      path->nodes[level] = node;
+      path->slots[level] = slot;
+    }
+    node = inner.children[slot];
+  }
+  return node;
+}
+
+/// @brief Insere o separador e o novo filho à direita dele no nó interno do nível dado, dividindo os nós cheios
+///        até a raiz; a divisão da raiz acrescenta um nível
+template<typename T>
+void BasicSparseMatrixBPTree<T>::insertSeparator(const Path &path, int level, std::uint64_t separator, int child) {
+  for (; level >= 0; level--) {
+    const int index = path.nodes[level];
+    const int slot = path.slots[level];
+
+    if (inners[index].count < NODE_KEYS) {
+      Inner &inner = inners[index];
+      std::copy_backward(inner.keys + slot, inner.keys + inner.count, inner.keys + inner.count + 1);
+      std::copy_backward(inner.children + slot + 1, inner.children + inner.count + 1,
+                         inner.children + inner.count + 2);
+      inner.keys[slot] = separator;
+      inner.children[slot + 1] = child;
+      inner.count++;
+      return;
+    }
+
+    std::uint64_t keys[NODE_KEYS + 1];
+    int children[NODE_KEYS + 2];
+    {
+      const Inner &inner = inners[index];
+      std::copy(inner.keys, inner.keys + slot, keys);
+      keys[slot] = separator;
+      std::copy(inner.keys + slot, inner.keys + NODE_KEYS, keys + slot + 1);
+      std::copy(inner.children, inner.children + slot + 1, children);
+      children[slot + 1] = child;
+      std::copy(inner.children + slot + 1, inner.children + NODE_KEYS + 1, children + slot + 2);
+    }
+
+    // A chave do meio sobe para o pai; as da esquerda ficam no nó e as da direita vão para o novo
+    constexpr int half = (NODE_KEYS + 1) / 2;
+    const int rightIndex = static_cast<int>(inners.size());
+    inners.emplace_back();
+    Inner &left = inners[index];
+    Inner &right = inners.back();
+
+    std::fill(left.keys, left.keys + NODE_KEYS, NO_KEY);
+    std::copy(keys, keys + half, left.keys);
+    std::copy(children, children + half + 1, left.children);
+    left.count = half;
+
+    std::copy(keys + half + 1, keys + NODE_KEYS + 1, right.keys);
+    std::copy(children + half + 1, children + NODE_KEYS + 2, right.children);
+    right.count = NODE_KEYS - half;
+
+    separator = keys[half];
+    child = rightIndex;
+  }
+
+  const int top = static_cast<int>(inners.size());
+  Inner &newRoot = inners.emplace_back();
+  newRoot.keys[0] = separator;
+  newRoot.children[0] = root;
+  newRoot.children[1] = child;
+  newRoot.count = 1;
+  root = top;
+  height++;
+  assert(height <= MAX_HEIGHT);
+}
+
+/// @brief Insere ou atualiza a chave. Uma folha cheia é dividida ao meio e a menor chave da nova folha
+///        (à direita) sobe como separador
+template<typename T>
+void BasicSparseMatrixBPTree<T>::insert(const std::uint64_t key, const T value) {
+  Path path;
+  const int leafIndex = findLeaf(key, &path);
+  int position = countNotAbove<NODE_KEYS>(leaves[leafIndex].keys, key);
+  if (position > 0 && leaves[leafIndex].keys[position - 1] == key) {
+    leaves[leafIndex].values[position - 1] = value;
+    return;
+  }
+  elements++;
+
+  int targetIndex = leafIndex;
+  if (leaves[leafIndex].count == NODE_KEYS) {
+    constexpr int half = NODE_KEYS / 2;
+    const int rightIndex = static_cast<int>(leaves.size());
+    leaves.emplace_back();
+    Leaf &left = leaves[leafIndex];
+    Leaf &right = leaves.back();
+
+    std::copy(left.keys + half, left.keys + NODE_KEYS, right.keys);
+    std::copy(left.values + half, left.values + NODE_KEYS, right.values);
+    std::fill(left.keys + half, left.keys + NODE_KEYS, NO_KEY);
+    right.count = NODE_KEYS - half;
+    left.count = half;
+    right.next = left.next;
+    left.next = rightIndex;
+
+    if (position > half) {
+      targetIndex = rightIndex;
+      position -= half;
+    }
+    insertSeparator(path, height - 1, right.keys[0], rightIndex);
+  }
+
+  Leaf &target = leaves[targetIndex];
+  std::copy_backward(target.keys + position, target.keys + target.count, target.keys + target.count + 1);
+  std::copy_backward(target.values + position, target.values + target.count, target.values + target.count + 1);
+  target.keys[position] = key;
+  target.values[position] = value;
+  target.count++;
+}
+
+/// @brief Remove a chave da sua folha, sem fundir folhas: os separadores continuam delimitando as folhas
+template<typename T>
+void BasicSparseMatrixBPTree<T>::erase(const std::uint64_t key) {
+  Leaf &leaf = leaves[findLeaf(key)];
+  const int position = countNotAbove<NODE_KEYS>(leaf.keys, key) - 1;
+  if (position < 0 || leaf.keys[position] != key) {
+    return;
+  }
+
+  std::copy(leaf.keys + position + 1, leaf.keys + leaf.count, leaf.keys + position);
+  std::copy(leaf.values + position + 1, leaf.values + leaf.count, leaf.values + position);
+  leaf.count--;
+  leaf.keys[leaf.count] = NO_KEY;
+  elements--;
+}
+
+/// @brief Aplica o fator pendente aos valores guardados, antes de uma escrita
+template<typename T>
+void BasicSparseMatrixBPTree<T>::materialize() {
+  if (scale == T(1)) {
+    return;
+  }
+  for (Leaf &leaf: leaves) {
+    for (int s = 0; s < leaf.count; s++) {
+      leaf.values[s] *= scale;
+    }
+  }
+  scale = T(1);
+}
+
+/// @brief Percorre as folhas encadeadas chamando visit(chave, valor guardado) em ordem de (linha, coluna)
+template<typename T>
+template<typename Visit>
+void BasicSparseMatrixBPTree<T>::forEach(Visit &&visit) const {
+  for (int leaf = 0; leaf != -1; leaf = leaves[leaf].next) {
+    const Leaf &current = leaves[leaf];
+    for (int s = 0; s < current.count; s++) {
+      visit(current.keys[s], current.values[s]);
+    }
+  }
+}
+
+template<typename T>
+T BasicSparseMatrixBPTree<T>::get(const int i, const int j) const {
+  const std::uint64_t key = pack(i, j);
+  const Leaf &leaf = leaves[findLeaf(key)];
+  const int position = countNotAbove<NODE_KEYS>(leaf.keys, key) - 1;
+  return position >= 0 && leaf.keys[position] == key ? scale * leaf.values[position] : T{};
+}
+
+template<typename T>
+void BasicSparseMatrixBPTree<T>::set(const int i, const int j, const T value) {
+  assert(0 <= i && i < n && 0 <= j && j < m);
+  materialize();
+  if (value == T{})
+    erase(pack(i, j));
+  else
+    insert(pack(i, j), value);
+}
+
+/// @brief Elementos em ordem de (linha, coluna)
+template<typename T>
+std::vector<std::tuple<int, int, T> > BasicSparseMatrixBPTree<T>::items() const {
+  std::vector<std::tuple<int, int, T> > entries;
+  entries.reserve(elements);
+  forEach([&](const std::uint64_t key, const T value) {
+    entries.emplace_back(keyRow(key), keyColumn(key), scale * value);
+  });
+  return entries;
+}
+
+/// @brief Elementos da linha i em ordem de coluna: desce até a primeira chave da linha e segue as folhas,
+///        em O(log k + elementos da linha)
+template<typename T>
+std::vector<std::pair<int, T> > BasicSparseMatrixBPTree<T>::row(const int i) const {
+  assert(0 <= i && i < n);
+
+  std::vector<std::pair<int, T> > entries;
+  const std::uint64_t first = pack(i, 0);
+  int leaf = findLeaf(first);
+  int position = countNotAbove<NODE_KEYS>(leaves[leaf].keys, first);
+  if (position > 0 && leaves[leaf].keys[position - 1] == first) {
+    position--;
+  }
+
+  for (; leaf != -1; leaf = leaves[leaf].next, position = 0) {
+    const Leaf &current = leaves[leaf];
+    for (; position < current.count; position++) {
+      if (keyRow(current.keys[position]) != i) {
+        return entries;
+      }
+      entries.emplace_back(keyColumn(current.keys[position]), scale * current.values[position]);
+    }
+  }
+  return entries;
+}
+
+template<typename T>
+BasicSparseMatrixCSR<T> BasicSparseMatrixBPTree<T>::toCompressed() const {
+  return BasicSparseMatrixCSR<T>::fromTriplets(n, m, items());
+}
+
+/// @brief Transposta em O(k log k): as chaves trocadas são reordenadas e a árvore é reconstruída.
+///        O fator pendente é mantido
+template<typename T>
+BasicSparseMatrixBPTree<T> BasicSparseMatrixBPTree<T>::transpose() const {
+  std::vector<std::pair<std::uint64_t, T> > keyed;
+  keyed.reserve(elements);
+  forEach([&](const std::uint64_t key, const T value) {
+    keyed.emplace_back(pack(keyColumn(key), keyRow(key)), value);
+  });
+  std::sort(keyed.begin(), keyed.end(), [](const auto &x, const auto &y) { return x.first < y.first; });
+
+  BasicSparseMatrixBPTree C(m, n);
+  Builder builder(C);
+  for (const auto &[key, value]: keyed) {
+    builder.append(key, value);
+  }
+  builder.finish();
+  C.scale = scale;
+  return C;
+}
+
+/// @brief Soma por intercalação das folhas das duas matrizes, em O(kA + kB); o resultado é construído em
+///        ordem, com as folhas cheias
+template<typename T>
+BasicSparseMatrixBPTree<T> BasicSparseMatrixBPTree<T>::add(const BasicSparseMatrixBPTree &B) const {
+  assert(n == B.n && m == B.m);
+
+  struct Cursor {
+    const std::vector<Leaf> &leaves;
+    int leaf = 0;
+    int position = 0;
+
+    explicit Cursor(const std::vector<Leaf> &leaves) : leaves(leaves) {
+      skipEmpty();
+    }
+
+    void skipEmpty() {
+      while (leaf != -1 && position == leaves[leaf].count) {
+        leaf = leaves[leaf].next;
+        position = 0;
+      }
+    }
+
+    bool done() const {
+      return leaf == -1;
+    }
+
+    std::uint64_t key() const {
+      return done() ? NO_KEY : leaves[leaf].keys[position];
+    }
+
+    T value() const {
+      return leaves[leaf].values[position];
+    }
+
+    void advance() {
+      position++;
+      skipEmpty();
+    }
+  };
+
+  BasicSparseMatrixBPTree C(n, m);
+  Builder builder(C);
+  Cursor a(leaves), b(B.leaves);
+  while (!a.done() || !b.done()) {
+    const std::uint64_t keyA = a.key(), keyB = b.key();
+    if (keyA < keyB) {
+      builder.append(keyA, scale * a.value());
+      a.advance();
+    } else if (keyB < keyA) {
+      builder.append(keyB, B.scale * b.value());
+      b.advance();
+    } else {
+      if (const T sum = scale * a.value() + B.scale * b.value(); sum != T{}) {
+        builder.append(keyA, sum);
+      }
+      a.advance();
+      b.advance();
+    }
+  }
+  builder.finish();
+  return C;
+}
+
+template<typename T>
+BasicSparseMatrixBPTree<T> BasicSparseMatrixBPTree<T>::operator+(const BasicSparseMatrixBPTree &B) const {
+  return add(B);
+}
+
+template<typename T>
+BasicSparseMatrixBPTree<T> BasicSparseMatrixBPTree<T>::scalarMult(const T alpha) const {
+  if (alpha == T{}) {
+    return BasicSparseMatrixBPTree(n, m);
+  }
+
+  BasicSparseMatrixBPTree C = *this;
+  C.scalarMultInPlace(alpha);
+  return C;
+}
+
+/// @brief Multiplicação por escalar em O(1), acumulada no fator pendente; por zero, esvazia a árvore
+template<typename T>
+void BasicSparseMatrixBPTree<T>::scalarMultInPlace(const T alpha) {
+  if (alpha == T{}) {
+    *this = BasicSparseMatrixBPTree(n, m);
+    return;
+  }
+
+  scale *= alpha;
+}
+
+template<typename T>
+BasicSparseMatrixBPTree<T> &BasicSparseMatrixBPTree<T>::operator*=(const T alpha) {
+  scalarMultInPlace(alpha);
+  return *this;
+}
+
+/// @brief Produto pela forma comprimida, cujo resultado é reconstruído como árvore B+
+template<typename T>
+BasicSparseMatrixBPTree<T> BasicSparseMatrixBPTree<T>::mult(const BasicSparseMatrixBPTree &B) const {
+  assert(m == B.n);
+  return fromCompressed(toCompressed().mult(B.toCompressed()));
+}
+
+template<typename T>
+BasicSparseMatrixBPTree<T> BasicSparseMatrixBPTree<T>::multParallel(const BasicSparseMatrixBPTree &B,
+                                                                  ThreadPool &pool) const {
+  assert(m == B.n);
+  return fromCompressed(toCompressed().multParallel(B.toCompressed(), pool));
+}
+
+template<typename T>
+std::vector<T> BasicSparseMatrixBPTree<T>::multVector(const std::vector<T> &x) const {
+  assert(static_cast<int>(x.size()) == m);
+
+  std::vector<T> y(n, T{});
+  forEach([&](const std::uint64_t key, const T value) {
+    y[keyRow(key)] += value * x[keyColumn(key)];
+  });
+  if (scale != T(1)) {
+    for (T &value: y) {
+      value *= scale;
+    }
+  }
+  return y;
+}
+
+template<typename T>
+std::ostream &operator<<(std::ostream &os, const BasicSparseMatrixBPTree<T> &M) {
+  os << "SparseMatrixBPTree(" << M.n << "x" << M.m
+      << ", nnz=" << M.elements
+      << ", depth=" << M.depth() << ")";
+  return os;
+}
+
+template class BasicSparseMatrixBPTree<float>;
+template class BasicSparseMatrixBPTree<double>;
+template class BasicSparseMatrixBPTree<std::int32_t>;
+template class BasicSparseMatrixBPTree<std::int64_t>;
+
+template std::ostream &operator<<(std::ostream &os, const BasicSparseMatrixBPTree<float> &M);
+template std::ostream &operator<<(std::ostream &os, const BasicSparseMatrixBPTree<double> &M);
+template std::ostream &operator<<(std::ostream &os, const BasicSparseMatrixBPTree<std::int32_t> &M);
+template std::ostream &operator<<(std::ostream &os, const BasicSparseMatrixBPTree<std::int64_t> &M);
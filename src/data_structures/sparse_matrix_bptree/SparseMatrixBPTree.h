@@ -0,0 +1,147 @@
+#ifndef MC458_PROJETO_SPARSEMATRIXBPTREE_H
+#define MC458_PROJETO_SPARSEMATRIXBPTREE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "../sparse_matrix_csr/SparseMatrixCSR.h"
+#include "../../parallel/ThreadPool.h"
+
+// Matriz esparsa em árvore B+ ordenada por (linha, coluna) com elementos do tipo T, alternativa à árvore
+// rubronegra: cada nó guarda NODE_KEYS chaves de 64 bits contíguas (algumas linhas de cache), comparadas de uma
+// vez com SIMD, então uma busca desce log_B(k) nós em vez de log2(k). As folhas são encadeadas em ordem, o que
+// dá à varredura e à soma (intercalação) o mesmo percurso ordenado do inorder da árvore.
+// Os nós ficam em dois vetores e se referem uns aos outros por índice, então uma cópia é a cópia dos vetores.
+// A remoção não funde folhas, que podem esvaziar; a construção a partir de elementos ordenados enche as folhas.
+// Como na hash, a multiplicação por escalar só acumula o fator pendente scale.
+// Instanciada em SparseMatrixBPTree.cpp para float, double, int32_t e int64_t; SparseMatrixBPTree é a forma
+// com double
+template<typename T>
+class BasicSparseMatrixBPTree {
+public:
+  static constexpr int NODE_KEYS = 32;
+
+private:
+  static constexpr int MAX_HEIGHT = 16;
+
+  // Posições além de count guardam a maior chave possível, para que a comparação SIMD percorra o nó inteiro
+  struct alignas(64) Leaf {
+    std::uint64_t keys[NODE_KEYS];
+    T values[NODE_KEYS];
+    int count;
+    int next; // próxima folha na ordem das chaves, ou -1
+
+    Leaf();
+  };
+
+  // O filho c guarda as chaves em [keys[c - 1], keys[c]); são count chaves e count + 1 filhos
+  struct alignas(64) Inner {
+    std::uint64_t keys[NODE_KEYS];
+    int children[NODE_KEYS + 1];
+    int count;
+
+    Inner();
+  };
+
+  // Caminho de uma descida: nó interno e filho escolhido em cada nível, da raiz para as folhas
+  struct Path {
+    int nodes[MAX_HEIGHT];
+    int slots[MAX_HEIGHT];
+  };
+
+  class Builder;
+
+  int n, m;
+  int height; // níveis de nós internos acima das folhas; com 0, root é uma folha
+  int root;
+  size_t elements;
+  T scale = T(1);
+  std::vector<Inner> inners;
+  std::vector<Leaf> leaves; // leaves[0] é sempre a primeira folha da ordem
+
+  static std::uint64_t pack(int i, int j) {
+    return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(i)) << 32) | static_cast<std::uint32_t>(j);
+  }
+
+  int findLeaf(std::uint64_t key, Path *path = nullptr) const;
+
+  void insertSeparator(const Path &path, int level, std::uint64_t separator, int child);
+
+  void insert(std::uint64_t key, T value);
+
+  void erase(std::uint64_t key);
+
+  void materialize();
+
+  template<typename Visit>
+  void forEach(Visit &&visit) const;
+
+public:
+  using Value = T;
+
+  BasicSparseMatrixBPTree(int n, int m);
+
+  static BasicSparseMatrixBPTree fromSorted(int n, int m, const std::vector<std::tuple<int, int, T> > &entries);
+
+  static BasicSparseMatrixBPTree fromTriplets(int n, int m, std::vector<std::tuple<int, int, T> > entries);
+
+  static BasicSparseMatrixBPTree fromCompressed(const BasicSparseMatrixCSR<T> &A);
+
+  int rows() const;
+
+  int cols() const;
+
+  size_t nnz() const;
+
+  int depth() const;
+
+  T scaleFactor() const;
+
+  T get(int i, int j) const;
+
+  void set(int i, int j, T value);
+
+  std::vector<std::tuple<int, int, T> > items() const;
+
+  std::vector<std::pair<int, T> > row(int i) const;
+
+  BasicSparseMatrixCSR<T> toCompressed() const;
+
+  BasicSparseMatrixBPTree transpose() const;
+
+  BasicSparseMatrixBPTree add(const BasicSparseMatrixBPTree &B) const;
+
+  BasicSparseMatrixBPTree operator+(const BasicSparseMatrixBPTree &B) const;
+
+  BasicSparseMatrixBPTree scalarMult(T alpha) const;
+
+  void scalarMultInPlace(T alpha);
+
+  BasicSparseMatrixBPTree &operator*=(T alpha);
+
+  BasicSparseMatrixBPTree mult(const BasicSparseMatrixBPTree &B) const;
+
+  BasicSparseMatrixBPTree multParallel(const BasicSparseMatrixBPTree &B,
+                                       ThreadPool &pool = ThreadPool::shared()) const;
+
+  std::vector<T> multVector(const std::vector<T> &x) const;
+
+  template<typename U>
+  friend std::ostream &operator<<(std::ostream &os, const BasicSparseMatrixBPTree<U> &M);
+};
+
+template<typename T>
+std::ostream &operator<<(std::ostream &os, const BasicSparseMatrixBPTree<T> &M);
+
+extern template class BasicSparseMatrixBPTree<float>;
+extern template class BasicSparseMatrixBPTree<double>;
+extern template class BasicSparseMatrixBPTree<std::int32_t>;
+extern template class BasicSparseMatrixBPTree<std::int64_t>;
+
+using SparseMatrixBPTree = BasicSparseMatrixBPTree<double>;
+
+#endif //MC458_PROJETO_SPARSEMATRIXBPTREE_H
@@ -0,0 +1,595 @@
+#include "SparseMatrixCSR.h"
+#include "../sparse_accumulator/SparseAccumulator.h"
+#include "../../parallel/ParallelAccumulate.h"
+
+#include <algorithm>
+#include <cassert>
+#include <utility>
+
+/// @brief Assume os vetores construídos como armazenamento compartilhado da matriz
+template<typename T>
+BasicSparseMatrixCSR<T>::BasicSparseMatrixCSR(const int n, const int m, const bool byColumn, Arrays &&arrays)
+  : n{n}, m{m}, byColumn{byColumn} {
+  assert(arrays.offsets.size() == static_cast<size_t>(majorCount()) + 1);
+  const auto owned = std::make_shared<const Arrays>(std::move(arrays));
+  offsets = owned->offsets.data();
+  indices = owned->indices.data();
+  values = owned->values.data();
+  count = owned->values.size();
+  storage = owned;
+}
+
+/// @brief Constructor de uma matriz n x m sem elementos não nulos
+template<typename T>
+BasicSparseMatrixCSR<T>::BasicSparseMatrixCSR(const int n, const int m)
+  : BasicSparseMatrixCSR(n, m, false, Arrays(n)) {
+}
+
+/// @brief Matriz que lê os vetores comprimidos diretamente de memória externa, sem copiá-los
+/// @param offsets início de cada linha (ou coluna) em indices/values, com majors + 1 posições
+/// @param owner mantém a memória válida enquanto existir alguma cópia da matriz (pode ser nulo)
+template<typename T>
+BasicSparseMatrixCSR<T> BasicSparseMatrixCSR<T>::view(const int n, const int m, const bool byColumn, const int *offsets,
+                                                      const int *indices, const T *values,
+                                                      std::shared_ptr<const void> owner) {
+  BasicSparseMatrixCSR C(n, m);
+  C.byColumn = byColumn;
+  C.offsets = offsets;
+  C.indices = indices;
+  C.values = values;
+  C.count = static_cast<size_t>(offsets[C.majorCount()]);
+  C.storage = std::move(owner);
+  return C;
+}
+
+/// @brief Constrói a forma CSR a partir de triplas (linha, coluna, valor) em qualquer ordem, ordenando por contagem
+///        as linhas e depois cada linha por coluna. Triplas repetidas na mesma posição são somadas, e posições
+///        com valor (ou soma) zero não são guardadas
+/// @param n número de linhas
+/// @param m número de colunas
+/// @param entries triplas com 0 <= linha < n e 0 <= coluna < m
+/// @return matriz comprimida por linhas
+template<typename T>
+BasicSparseMatrixCSR<T> BasicSparseMatrixCSR<T>::fromTriplets(const int n, const int m,
+                                                              const std::vector<std::tuple<int, int, T> > &entries) {
+  Arrays C(n);
+
+  for (const auto &[i, j, value]: entries) {
+    assert(0 <= i && i < n && 0 <= j && j < m);
+    C.offsets[i + 1]++;
+  }
+  for (int i = 0; i < n; i++) {
+    C.offsets[i + 1] += C.offsets[i];
+  }
+
+  std::vector<std::pair<int, T> > sorted(entries.size());
+  std::vector<int> next(C.offsets.begin(), C.offsets.end() - 1);
+  for (const auto &[i, j, value]: entries) {
+    sorted[next[i]++] = {j, value};
+  }
+
+  // Após ordenar a linha, posições repetidas ficam vizinhas e são somadas, e uma soma nula é descartada antes
+  // da próxima posição; offsets[i] é reescrito com o início da linha já sem repetições (só depois de lido o
+  // início em sorted)
+  C.indices.reserve(sorted.size());
+  C.values.reserve(sorted.size());
+  int written = 0;
+  for (int i = 0; i < n; i++) {
+    const auto first = sorted.begin() + C.offsets[i];
+    const auto last = sorted.begin() + C.offsets[i + 1];
+    std::sort(first, last, [](const auto &x, const auto &y) { return x.first < y.first; });
+
+    C.offsets[i] = written;
+    const auto dropZero = [&]() {
+      if (written > C.offsets[i] && C.values.back() == T{}) {
+        C.indices.pop_back();
+        C.values.pop_back();
+        written--;
+      }
+    };
+    for (auto it = first; it != last; ++it) {
+      if (written > C.offsets[i] && C.indices.back() == it->first) {
+        C.values.back() += it->second;
+      } else {
+        dropZero();
+        C.indices.push_back(it->first);
+        C.values.push_back(it->second);
+        written++;
+      }
+    }
+    dropZero();
+  }
+  C.offsets[n] = written;
+
+  return BasicSparseMatrixCSR(n, m, false, std::move(C));
+}
+
+/// @brief Forma CSR da hash; reaproveita os índices da hash quando construídos
+template<typename T>
+BasicSparseMatrixCSR<T> BasicSparseMatrixCSR<T>::fromHash(const BasicSparseMatrixHash<T> &A) {
+  return A.toCompressed();
+}
+
+/// @brief Constrói a forma comprimida a partir do percurso inorder da árvore, em uma única passada.
+///        Como a árvore está ordenada por (linha, coluna) armazenadas, uma árvore transposta gera diretamente a forma CSC
+/// @param root nó raiz da árvore
+/// @param n número de linhas da matriz lógica
+/// @param m número de colunas da matriz lógica
+/// @param transpose flag que identifica se a árvore representa a transposta
+/// @return matriz comprimida (CSR, ou CSC se transpose)
+template<typename T>
+BasicSparseMatrixCSR<T> BasicSparseMatrixCSR<T>::fromTree(typename BasicSparseMatrixTree<T>::TreeNode *root,
+                                                          const int n, const int m, const bool transpose) {
+  std::vector<typename BasicSparseMatrixTree<T>::TreeNode *> nodes;
+  BasicSparseMatrixTree<T>::inorderGet(root, transpose, nodes);
+
+  const int majors = transpose ? m : n;
+  Arrays C(majors);
+  C.indices.reserve(nodes.size());
+  C.values.reserve(nodes.size());
+
+  for (const auto *node: nodes) {
+    C.offsets[node->row + 1]++;
+    C.indices.push_back(node->column);
+    C.values.push_back(node->value);
+  }
+  for (int p = 0; p < majors; p++) {
+    C.offsets[p + 1] += C.offsets[p];
+  }
+
+  return BasicSparseMatrixCSR(n, m, transpose, std::move(C));
+}
+
+template<typename T>
+int BasicSparseMatrixCSR<T>::rows() const {
+  return n;
+}
+
+template<typename T>
+int BasicSparseMatrixCSR<T>::cols() const {
+  return m;
+}
+
+template<typename T>
+size_t BasicSparseMatrixCSR<T>::nnz() const {
+  return count;
+}
+
+template<typename T>
+bool BasicSparseMatrixCSR<T>::isColumnMajor() const {
+  return byColumn;
+}
+
+/// @brief Vetores comprimidos (majors + 1 deslocamentos, nnz índices e valores), para gravação em arquivo
+template<typename T>
+const int *BasicSparseMatrixCSR<T>::offsetData() const {
+  return offsets;
+}
+
+template<typename T>
+const int *BasicSparseMatrixCSR<T>::indexData() const {
+  return indices;
+}
+
+template<typename T>
+const T *BasicSparseMatrixCSR<T>::valueData() const {
+  return values;
+}
+
+/// @brief Acesso a um elemento por busca binária dentro da linha (ou coluna) comprimida
+template<typename T>
+T BasicSparseMatrixCSR<T>::get(const int i, const int j) const {
+  const int major = byColumn ? j : i;
+  const int minor = byColumn ? i : j;
+
+  const int *first = indices + offsets[major];
+  const int *last = indices + offsets[major + 1];
+  const int *it = std::lower_bound(first, last, minor);
+
+  if (it == last || *it != minor) {
+    return T{};
+  }
+  return values[it - indices];
+}
+
+/// @brief Elementos não nulos da linha i, ordenados por coluna. Exige a forma CSR
+template<typename T>
+typename BasicSparseMatrixCSR<T>::Slice BasicSparseMatrixCSR<T>::row(const int i) const {
+  assert(!byColumn);
+  return {indices + offsets[i], values + offsets[i], offsets[i + 1] - offsets[i]};
+}
+
+/// @brief Elementos não nulos da coluna j, ordenados por linha. Exige a forma CSC
+template<typename T>
+typename BasicSparseMatrixCSR<T>::Slice BasicSparseMatrixCSR<T>::col(const int j) const {
+  assert(byColumn);
+  return {indices + offsets[j], values + offsets[j], offsets[j + 1] - offsets[j]};
+}
+
+/// @brief Bloco [r0, r1) x [c0, c1) com índices a partir de (r0, c0), na mesma forma (CSR ou CSC). Cada linha
+///        (ou coluna) do bloco localiza o trecho por busca binária: O(linhas * log + saída)
+template<typename T>
+BasicSparseMatrixCSR<T> BasicSparseMatrixCSR<T>::submatrix(const int r0, const int r1, const int c0,
+                                                           const int c1) const {
+  assert(0 <= r0 && r0 <= r1 && r1 <= n && 0 <= c0 && c0 <= c1 && c1 <= m);
+
+  const int majorBegin = byColumn ? c0 : r0, majorEnd = byColumn ? c1 : r1;
+  const int minorBegin = byColumn ? r0 : c0, minorEnd = byColumn ? r1 : c1;
+  Arrays C(majorEnd - majorBegin);
+
+  for (int p = majorBegin; p < majorEnd; p++) {
+    const int *last = indices + offsets[p + 1];
+    const int *begin = std::lower_bound(indices + offsets[p], last, minorBegin);
+    const int *end = std::lower_bound(begin, last, minorEnd);
+    for (const int *it = begin; it != end; ++it) {
+      C.indices.push_back(*it - minorBegin);
+      C.values.push_back(values[it - indices]);
+    }
+    C.offsets[p - majorBegin + 1] = static_cast<int>(C.values.size());
+  }
+
+  return BasicSparseMatrixCSR(r1 - r0, c1 - c0, byColumn, std::move(C));
+}
+
+/// @brief Troca a dimensão principal da compressão por contagem (CSC -> CSR), em O(n + m + k)
+template<typename T>
+BasicSparseMatrixCSR<T> BasicSparseMatrixCSR<T>::toRowMajor() const {
+  if (!byColumn) {
+    return *this;
+  }
+  return transpose().toColumnMajor().transpose();
+}
+
+/// @brief Troca a dimensão principal da compressão por contagem (CSR -> CSC), em O(n + m + k)
+template<typename T>
+BasicSparseMatrixCSR<T> BasicSparseMatrixCSR<T>::toColumnMajor() const {
+  if (byColumn) {
+    return *this;
+  }
+
+  Arrays C(m);
+  C.indices.resize(count);
+  C.values.resize(count);
+
+  for (size_t q = 0; q < count; q++) {
+    C.offsets[indices[q] + 1]++;
+  }
+  for (int j = 0; j < m; j++) {
+    C.offsets[j + 1] += C.offsets[j];
+  }
+
+  std::vector<int> next(C.offsets.begin(), C.offsets.end() - 1);
+  for (int i = 0; i < n; i++) {
+    for (int p = offsets[i]; p < offsets[i + 1]; p++) {
+      const int q = next[indices[p]]++;
+      C.indices[q] = i;
+      C.values[q] = values[p];
+    }
+  }
+
+  return BasicSparseMatrixCSR(n, m, true, std::move(C));
+}
+
+/// @brief Transposta: os mesmos vetores, compartilhados, reinterpretados com a dimensão principal trocada
+///        (CSR de A = CSC de A^T)
+template<typename T>
+BasicSparseMatrixCSR<T> BasicSparseMatrixCSR<T>::transpose() const {
+  BasicSparseMatrixCSR C = *this;
+  std::swap(C.n, C.m);
+  C.byColumn = !byColumn;
+  return C;
+}
+
+template<typename T>
+std::vector<std::tuple<int, int, T> > BasicSparseMatrixCSR<T>::items() const {
+  std::vector<std::tuple<int, int, T> > items;
+  items.reserve(count);
+
+  for (int p = 0; p < majorCount(); p++) {
+    for (int q = offsets[p]; q < offsets[p + 1]; q++) {
+      if (!byColumn) {
+        items.emplace_back(p, indices[q], values[q]);
+      } else {
+        items.emplace_back(indices[q], p, values[q]);
+      }
+    }
+  }
+
+  return items;
+}
+
+/// @brief Soma por intercalação das linhas (ou colunas) ordenadas; o resultado mantém a forma de A
+template<typename T>
+BasicSparseMatrixCSR<T> BasicSparseMatrixCSR<T>::add(const BasicSparseMatrixCSR &B) const {
+  assert(n == B.n && m == B.m);
+
+  const BasicSparseMatrixCSR other = byColumn ? B.toColumnMajor() : B.toRowMajor();
+  Arrays C(majorCount());
+  C.indices.reserve(count + other.count);
+  C.values.reserve(count + other.count);
+
+  for (int p = 0; p < majorCount(); p++) {
+    int a = offsets[p], b = other.offsets[p];
+    const int aEnd = offsets[p + 1], bEnd = other.offsets[p + 1];
+
+    while (a < aEnd || b < bEnd) {
+      if (b >= bEnd || (a < aEnd && indices[a] < other.indices[b])) {
+        C.indices.push_back(indices[a]);
+        C.values.push_back(values[a++]);
+      } else if (a >= aEnd || other.indices[b] < indices[a]) {
+        C.indices.push_back(other.indices[b]);
+        C.values.push_back(other.values[b++]);
+      } else {
+        const T sum = values[a++] + other.values[b++];
+        if (sum != T{}) {
+          C.indices.push_back(other.indices[b - 1]);
+          C.values.push_back(sum);
+        }
+      }
+    }
+    C.offsets[p + 1] = static_cast<int>(C.values.size());
+  }
+
+  return BasicSparseMatrixCSR(n, m, byColumn, std::move(C));
+}
+
+template<typename T>
+BasicSparseMatrixCSR<T> BasicSparseMatrixCSR<T>::operator+(const BasicSparseMatrixCSR &B) const {
+  return add(B);
+}
+
+/// @brief Cópia com os valores multiplicados por alpha e a mesma estrutura
+template<typename T>
+BasicSparseMatrixCSR<T> BasicSparseMatrixCSR<T>::scalarMult(const T alpha) const {
+  Arrays C(0);
+  C.offsets.assign(offsets, offsets + majorCount() + 1);
+  C.indices.assign(indices, indices + count);
+  C.values.resize(count);
+  for (size_t p = 0; p < count; p++) {
+    C.values[p] = alpha * values[p];
+  }
+  return BasicSparseMatrixCSR(n, m, byColumn, std::move(C));
+}
+
+/// @brief Multiplicação linha a linha (Gustavson): cada linha de C acumula combinações das linhas de B
+///        em um acumulador esparso e é emitida já ordenada; o resultado é CSR
+template<typename T>
+BasicSparseMatrixCSR<T> BasicSparseMatrixCSR<T>::mult(const BasicSparseMatrixCSR &B) const {
+  assert(m == B.n);
+
+  const BasicSparseMatrixCSR a = toRowMajor();
+  const BasicSparseMatrixCSR b = B.toRowMajor();
+  Arrays C(n);
+  SparseAccumulator<T> accumulator(B.m);
+
+  for (int i = 0; i < n; i++) {
+    for (int p = a.offsets[i]; p < a.offsets[i + 1]; p++) {
+      const int k = a.indices[p];
+      const T aValue = a.values[p];
+
+      for (int q = b.offsets[k]; q < b.offsets[k + 1]; q++) {
+        accumulator.add(b.indices[q], aValue * b.values[q]);
+      }
+    }
+
+    accumulator.flush(true, [&](const int j, const T value) {
+      C.indices.push_back(j);
+      C.values.push_back(value);
+    });
+    C.offsets[i + 1] = static_cast<int>(C.values.size());
+  }
+
+  return BasicSparseMatrixCSR(n, B.m, false, std::move(C));
+}
+
+/// @brief Multiplicação de Gustavson em paralelo. As linhas de C são divididas em faixas contíguas com
+///        aproximadamente o mesmo número de produtos parciais (não de linhas), cada faixa usa seu próprio
+///        acumulador e vetores locais, e o resultado é montado copiando cada faixa para sua posição final
+/// @param B matriz da direita
+/// @param pool conjunto de threads
+/// @return matriz CSR resultante
+template<typename T>
+BasicSparseMatrixCSR<T> BasicSparseMatrixCSR<T>::multParallel(const BasicSparseMatrixCSR &B, ThreadPool &pool) const {
+  assert(m == B.n);
+
+  const BasicSparseMatrixCSR a = toRowMajor();
+  const BasicSparseMatrixCSR b = B.toRowMajor();
+
+  // Custo estimado acumulado: flops[i] = produtos parciais das linhas 0..i-1
+  std::vector<long long> flops(static_cast<size_t>(n) + 1, 0);
+  for (int i = 0; i < n; i++) {
+    long long rowFlops = 0;
+    for (int p = a.offsets[i]; p < a.offsets[i + 1]; p++) {
+      rowFlops += b.offsets[a.indices[p] + 1] - b.offsets[a.indices[p]];
+    }
+    flops[i + 1] = flops[i] + rowFlops;
+  }
+
+  const int chunks = std::max(1, std::min(n, pool.size() * 4));
+  std::vector<int> bounds(chunks + 1, n);
+  bounds[0] = 0;
+  for (int c = 1; c < chunks; c++) {
+    const long long target = flops[n] * c / chunks;
+    bounds[c] = static_cast<int>(std::lower_bound(flops.begin(), flops.end(), target) - flops.begin());
+    bounds[c] = std::max(bounds[c], bounds[c - 1]);
+  }
+
+  std::vector<std::vector<int> > chunkIndices(chunks);
+  std::vector<std::vector<T> > chunkValues(chunks);
+  Arrays C(n);
+
+  pool.run(chunks, [&](const int c) {
+    SparseAccumulator<T> accumulator(B.m);
+    std::vector<int> &localIndices = chunkIndices[c];
+    std::vector<T> &localValues = chunkValues[c];
+
+    for (int i = bounds[c]; i < bounds[c + 1]; i++) {
+      for (int p = a.offsets[i]; p < a.offsets[i + 1]; p++) {
+        const int k = a.indices[p];
+        const T aValue = a.values[p];
+
+        for (int q = b.offsets[k]; q < b.offsets[k + 1]; q++) {
+          accumulator.add(b.indices[q], aValue * b.values[q]);
+        }
+      }
+
+      accumulator.flush(true, [&](const int j, const T value) {
+        localIndices.push_back(j);
+        localValues.push_back(value);
+      });
+      // Contagem local da linha; convertida em deslocamento global depois
+      C.offsets[i + 1] = static_cast<int>(localValues.size());
+    }
+  });
+
+  std::vector<int> chunkStart(chunks + 1, 0);
+  for (int c = 0; c < chunks; c++) {
+    chunkStart[c + 1] = chunkStart[c] + static_cast<int>(chunkValues[c].size());
+  }
+  C.indices.resize(chunkStart[chunks]);
+  C.values.resize(chunkStart[chunks]);
+
+  pool.run(chunks, [&](const int c) {
+    for (int i = bounds[c]; i < bounds[c + 1]; i++) {
+      C.offsets[i + 1] += chunkStart[c];
+    }
+    std::copy(chunkIndices[c].begin(), chunkIndices[c].end(), C.indices.begin() + chunkStart[c]);
+    std::copy(chunkValues[c].begin(), chunkValues[c].end(), C.values.begin() + chunkStart[c]);
+  });
+
+  return BasicSparseMatrixCSR(n, B.m, false, std::move(C));
+}
+
+template<typename T>
+BasicSparseMatrixCSR<T> BasicSparseMatrixCSR<T>::operator*(const BasicSparseMatrixCSR &B) const {
+  return mult(B);
+}
+
+/// @brief Núcleo de y += op(A) * x para as linhas (ou colunas) comprimidas [majorBegin, majorEnd), com x e y
+///        densos de largura width em ordem por linhas. Quando op(A) percorre A pela sua dimensão principal,
+///        cada saída é um produto escalar contíguo (gather); caso contrário os produtos são espalhados (scatter)
+template<typename T>
+void BasicSparseMatrixCSR<T>::productRange(const bool transpose, const T *x, T *y, const int width,
+                                           const int majorBegin, const int majorEnd) const {
+  const bool gather = byColumn == transpose;
+
+  for (int p = majorBegin; p < majorEnd; p++) {
+    if (width == 1) {
+      if (gather) {
+        T sum{};
+        for (int q = offsets[p]; q < offsets[p + 1]; q++) {
+          sum += values[q] * x[indices[q]];
+        }
+        y[p] += sum;
+      } else {
+        const T xValue = x[p];
+        for (int q = offsets[p]; q < offsets[p + 1]; q++) {
+          y[indices[q]] += values[q] * xValue;
+        }
+      }
+      continue;
+    }
+
+    for (int q = offsets[p]; q < offsets[p + 1]; q++) {
+      const T value = values[q];
+      const T *__restrict source = x + static_cast<size_t>(gather ? indices[q] : p) * width;
+      T *__restrict target = y + static_cast<size_t>(gather ? p : indices[q]) * width;
+      for (int c = 0; c < width; c++) {
+        target[c] += value * source[c];
+      }
+    }
+  }
+}
+
+/// @brief y += op(A) * x. Em paralelo, o modo gather divide as saídas por faixas com o mesmo número
+///        de não nulos; o modo scatter acumula em vetores locais por tarefa que depois são somados
+/// @param pool conjunto de threads, ou nulo para executar em série
+template<typename T>
+void BasicSparseMatrixCSR<T>::product(const bool transpose, const T *x, T *y, const int width, ThreadPool *pool) const {
+  const int majors = majorCount();
+  if (pool == nullptr || pool->size() == 1) {
+    productRange(transpose, x, y, width, 0, majors);
+    return;
+  }
+
+  const int chunks = std::max(1, std::min(majors, pool->size() * 4));
+  std::vector<int> bounds(chunks + 1, majors);
+  bounds[0] = 0;
+  for (int c = 1; c < chunks; c++) {
+    const long long target = static_cast<long long>(count) * c / chunks;
+    bounds[c] = static_cast<int>(std::lower_bound(offsets, offsets + majors + 1, target) - offsets);
+    bounds[c] = std::max(std::min(bounds[c], majors), bounds[c - 1]);
+  }
+
+  if (byColumn == transpose) {
+    pool->run(chunks, [&](const int c) {
+      productRange(transpose, x, y, width, bounds[c], bounds[c + 1]);
+    });
+  } else {
+    const size_t outputs = static_cast<size_t>(transpose ? m : n) * width;
+    parallelAccumulate(*pool, chunks, outputs, y, [&](const int c, T *local) {
+      productRange(transpose, x, local, width, bounds[c], bounds[c + 1]);
+    });
+  }
+}
+
+/// @brief Produto matriz-vetor y = A * x (ou A^T * x)
+template<typename T>
+std::vector<T> BasicSparseMatrixCSR<T>::multVector(const std::vector<T> &x, const bool transpose) const {
+  assert(x.size() == static_cast<size_t>(transpose ? n : m));
+
+  std::vector<T> y(transpose ? m : n, T{});
+  product(transpose, x.data(), y.data(), 1, nullptr);
+  return y;
+}
+
+template<typename T>
+std::vector<T> BasicSparseMatrixCSR<T>::multVectorParallel(const std::vector<T> &x, const bool transpose,
+                                                           ThreadPool &pool) const {
+  assert(x.size() == static_cast<size_t>(transpose ? n : m));
+
+  std::vector<T> y(transpose ? m : n, T{});
+  product(transpose, x.data(), y.data(), 1, &pool);
+  return y;
+}
+
+/// @brief Produto por um bloco denso estreito Y = A * X (ou A^T * X); cada não nulo atualiza uma linha
+///        inteira e contígua de Y
+template<typename T>
+BasicDenseMatrix<T> BasicSparseMatrixCSR<T>::multDense(const BasicDenseMatrix<T> &X, const bool transpose) const {
+  assert(X.rows() == (transpose ? n : m));
+
+  BasicDenseMatrix<T> Y(transpose ? m : n, X.cols());
+  product(transpose, X.rowData(0), Y.rowData(0), X.cols(), nullptr);
+  Y *= X.scaleFactor();
+  return Y;
+}
+
+template<typename T>
+BasicDenseMatrix<T> BasicSparseMatrixCSR<T>::multDenseParallel(const BasicDenseMatrix<T> &X, const bool transpose,
+                                                               ThreadPool &pool) const {
+  assert(X.rows() == (transpose ? n : m));
+
+  BasicDenseMatrix<T> Y(transpose ? m : n, X.cols());
+  product(transpose, X.rowData(0), Y.rowData(0), X.cols(), &pool);
+  Y *= X.scaleFactor();
+  return Y;
+}
+
+template<typename T>
+std::ostream &operator<<(std::ostream &os, const BasicSparseMatrixCSR<T> &M) {
+  os << "SparseMatrixCSR(" << M.n << "x" << M.m
+      << ", nnz=" << M.count
+      << ", byColumn=" << (M.byColumn ? "true" : "false") << ")";
+  return os;
+}
+
+template class BasicSparseMatrixCSR<float>;
+template class BasicSparseMatrixCSR<double>;
+template class BasicSparseMatrixCSR<std::int32_t>;
+template class BasicSparseMatrixCSR<std::int64_t>;
+
+template std::ostream &operator<<(std::ostream &os, const BasicSparseMatrixCSR<float> &M);
+template std::ostream &operator<<(std::ostream &os, const BasicSparseMatrixCSR<double> &M);
+template std::ostream &operator<<(std::ostream &os, const BasicSparseMatrixCSR<std::int32_t> &M);
+template std::ostream &operator<<(std::ostream &os, const BasicSparseMatrixCSR<std::int64_t> &M);
@@ -0,0 +1,138 @@
+#ifndef MC458_PROJETO_SPARSEMATRIXCSR_H
+#define MC458_PROJETO_SPARSEMATRIXCSR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <tuple>
+#include <iostream>
+
+#include "../sparse_matrix_hash/SparseMatrixHash.h"
+#include "../sparse_matrix_tree/SparseMatrixTree.h"
+#include "../dense_matrix/DenseMatrix.h"
+#include "../../parallel/ThreadPool.h"
+
+// Estrutura 3: matriz comprimida imutável (CSR, ou CSC quando byColumn = true).
+// Os vetores comprimidos são só lidos depois de construídos, então cópias compartilham o mesmo
+// armazenamento, e uma matriz pode enxergar memória externa (por exemplo um arquivo mapeado) sem copiá-la.
+// Os valores são do tipo T, instanciado em SparseMatrixCSR.cpp para float, double, int32_t e int64_t;
+// SparseMatrixCSR é a forma com double
+template<typename T>
+class BasicSparseMatrixCSR {
+  // Vetores de uma matriz em construção
+  struct Arrays {
+    std::vector<int> offsets;
+    std::vector<int> indices;
+    std::vector<T> values;
+
+    explicit Arrays(size_t majors) : offsets(majors + 1, 0) {
+    }
+  };
+
+  int n, m;
+  bool byColumn;
+  std::shared_ptr<const void> storage;
+  const int *offsets;
+  const int *indices;
+  const T *values;
+  size_t count;
+
+  BasicSparseMatrixCSR(int n, int m, bool byColumn, Arrays &&arrays);
+
+  int majorCount() const {
+    return byColumn ? m : n;
+  }
+
+  void productRange(bool transpose, const T *x, T *y, int width, int majorBegin, int majorEnd) const;
+
+  void product(bool transpose, const T *x, T *y, int width, ThreadPool *pool) const;
+
+public:
+  using Value = T;
+
+  struct Slice {
+    const int *index;
+    const T *value;
+    int size;
+  };
+
+  BasicSparseMatrixCSR(int n, int m);
+
+  static BasicSparseMatrixCSR view(int n, int m, bool byColumn, const int *offsets, const int *indices,
+                                   const T *values, std::shared_ptr<const void> owner);
+
+  static BasicSparseMatrixCSR fromTriplets(int n, int m, const std::vector<std::tuple<int, int, T> > &entries);
+
+  static BasicSparseMatrixCSR fromHash(const BasicSparseMatrixHash<T> &A);
+
+  static BasicSparseMatrixCSR fromTree(typename BasicSparseMatrixTree<T>::TreeNode *root, int n, int m,
+                                       bool transpose);
+
+  int rows() const;
+
+  int cols() const;
+
+  size_t nnz() const;
+
+  bool isColumnMajor() const;
+
+  const int *offsetData() const;
+
+  const int *indexData() const;
+
+  const T *valueData() const;
+
+  T get(int i, int j) const;
+
+  Slice row(int i) const;
+
+  Slice col(int j) const;
+
+  BasicSparseMatrixCSR submatrix(int r0, int r1, int c0, int c1) const;
+
+  BasicSparseMatrixCSR toRowMajor() const;
+
+  BasicSparseMatrixCSR toColumnMajor() const;
+
+  BasicSparseMatrixCSR transpose() const;
+
+  std::vector<std::tuple<int, int, T> > items() const;
+
+  BasicSparseMatrixCSR add(const BasicSparseMatrixCSR &B) const;
+
+  BasicSparseMatrixCSR operator+(const BasicSparseMatrixCSR &B) const;
+
+  BasicSparseMatrixCSR scalarMult(T alpha) const;
+
+  BasicSparseMatrixCSR mult(const BasicSparseMatrixCSR &B) const;
+
+  BasicSparseMatrixCSR multParallel(const BasicSparseMatrixCSR &B, ThreadPool &pool = ThreadPool::shared()) const;
+
+  BasicSparseMatrixCSR operator*(const BasicSparseMatrixCSR &B) const;
+
+  std::vector<T> multVector(const std::vector<T> &x, bool transpose = false) const;
+
+  std::vector<T> multVectorParallel(const std::vector<T> &x, bool transpose = false,
+                                    ThreadPool &pool = ThreadPool::shared()) const;
+
+  BasicDenseMatrix<T> multDense(const BasicDenseMatrix<T> &X, bool transpose = false) const;
+
+  BasicDenseMatrix<T> multDenseParallel(const BasicDenseMatrix<T> &X, bool transpose = false,
+                                        ThreadPool &pool = ThreadPool::shared()) const;
+
+  template<typename U>
+  friend std::ostream &operator<<(std::ostream &os, const BasicSparseMatrixCSR<U> &M);
+};
+
+template<typename T>
+std::ostream &operator<<(std::ostream &os, const BasicSparseMatrixCSR<T> &M);
+
+extern template class BasicSparseMatrixCSR<float>;
+extern template class BasicSparseMatrixCSR<double>;
+extern template class BasicSparseMatrixCSR<std::int32_t>;
+extern template class BasicSparseMatrixCSR<std::int64_t>;
+
+using SparseMatrixCSR = BasicSparseMatrixCSR<double>;
+
+#endif //MC458_PROJETO_SPARSEMATRIXCSR_H
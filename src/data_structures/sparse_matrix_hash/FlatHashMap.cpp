@@ -0,0 +1,177 @@
+#include "FlatHashMap.h"
+
+#include <utility>
+
+/// @brief Misturador final do MurmurHash3 (fmix64): espalha linha e coluna por todos os bits do índice
+template<typename V>
+std::uint64_t BasicFlatHashMap<V>::mix(std::uint64_t key) {
+  key ^= key >> 33;
+  key *= 0xff51afd7ed558ccdULL;
+  key ^= key >> 33;
+  key *= 0xc4ceb9fe1a85ec53ULL;
+  key ^= key >> 33;
+  return key;
+}
+
+template<typename V>
+size_t BasicFlatHashMap<V>::size() const {
+  return count;
+}
+
+/// @brief Número de posições da tabela (ocupadas ou não)
+template<typename V>
+size_t BasicFlatHashMap<V>::capacity() const {
+  return keys.size();
+}
+
+template<typename V>
+bool BasicFlatHashMap<V>::empty() const {
+  return count == 0;
+}
+
+template<typename V>
+void BasicFlatHashMap<V>::clear() {
+  keys.clear();
+  values.clear();
+  count = 0;
+  mask = 0;
+}
+
+/// @brief Garante capacidade para os elementos dados sem ultrapassar a carga máxima de 7/8
+template<typename V>
+void BasicFlatHashMap<V>::reserve(const size_t elements) {
+  size_t capacity = 16;
+  while (capacity - capacity / 8 < elements) {
+    capacity *= 2;
+  }
+  if (capacity > keys.size()) {
+    rehash(capacity);
+  }
+}
+
+/// @brief Reconstrói a tabela com a nova capacidade (potência de 2), reinserindo todos os elementos
+template<typename V>
+void BasicFlatHashMap<V>::rehash(const size_t capacity) {
+  std::vector<std::uint64_t> oldKeys(capacity, EMPTY);
+  std::vector<V> oldValues(capacity);
+  oldKeys.swap(keys);
+  oldValues.swap(values);
+  mask = capacity - 1;
+  count = 0;
+
+  for (size_t slot = 0; slot < oldKeys.size(); slot++) {
+    if (oldKeys[slot] != EMPTY) {
+      (*this)[oldKeys[slot]] = oldValues[slot];
+    }
+  }
+}
+
+/// @brief Sonda a partir da posição inicial da chave; pelo invariante Robin Hood a busca para assim que
+///        encontra um elemento mais perto da sua posição inicial do que a chave procurada estaria
+/// @return posição da chave, ou keys.size() se ausente
+template<typename V>
+size_t BasicFlatHashMap<V>::findSlot(const std::uint64_t key) const {
+  if (count == 0) {
+    return keys.size();
+  }
+
+  size_t slot = home(key);
+  for (size_t dist = 0;; dist++) {
+    if (keys[slot] == key) {
+      return slot;
+    }
+    if (keys[slot] == EMPTY || distance(slot) < dist) {
+      return keys.size();
+    }
+    slot = (slot + 1) & mask;
+  }
+}
+
+template<typename V>
+const V *BasicFlatHashMap<V>::find(const std::uint64_t key) const {
+  const size_t slot = findSlot(key);
+  return slot == keys.size() ? nullptr : &values[slot];
+}
+
+template<typename V>
+V *BasicFlatHashMap<V>::find(const std::uint64_t key) {
+  const size_t slot = findSlot(key);
+  return slot == keys.size() ? nullptr : &values[slot];
+}
+
+/// @brief Pede ao processador as linhas de cache da posição inicial da chave (chave e valor) sem esperar
+///        por elas, para que a busca seguinte, feita um pouco depois, não pare numa falta de cache
+template<typename V>
+void BasicFlatHashMap<V>::prefetch(const std::uint64_t key) const {
+  if (!keys.empty()) {
+    const size_t slot = home(key);
+    __builtin_prefetch(&keys[slot]);
+    __builtin_prefetch(&values[slot]);
+  }
+}
+
+/// @brief Acessa o valor da chave, inserindo zero se ausente. Na inserção, um elemento mais distante
+///        da sua posição inicial toma o lugar de um mais próximo, que segue sondando (Robin Hood)
+template<typename V>
+V &BasicFlatHashMap<V>::operator[](const std::uint64_t key) {
+  if (const size_t slot = findSlot(key); slot != keys.size()) {
+    return values[slot];
+  }
+  if (count + 1 > keys.size() - keys.size() / 8) {
+    rehash(keys.empty() ? 16 : keys.size() * 2);
+  }
+
+  std::uint64_t carriedKey = key;
+  V carriedValue{};
+  size_t slot = home(key);
+  size_t dist = 0;
+  size_t result = keys.size();
+
+  while (true) {
+    if (keys[slot] == EMPTY) {
+      keys[slot] = carriedKey;
+      values[slot] = carriedValue;
+      count++;
+      return values[result == keys.size() ? slot : result];
+    }
+
+    if (const size_t existing = distance(slot); existing < dist) {
+      std::swap(carriedKey, keys[slot]);
+      std::swap(carriedValue, values[slot]);
+      if (result == keys.size()) {
+        result = slot;
+      }
+      dist = existing;
+    }
+
+    slot = (slot + 1) & mask;
+    dist++;
+  }
+}
+
+/// @brief Remove a chave deslocando para trás os elementos seguintes que estão fora da posição inicial
+/// @return verdadeiro se a chave existia
+template<typename V>
+bool BasicFlatHashMap<V>::erase(const std::uint64_t key) {
+  size_t slot = findSlot(key);
+  if (slot == keys.size()) {
+    return false;
+  }
+
+  size_t next = (slot + 1) & mask;
+  while (keys[next] != EMPTY && distance(next) > 0) {
+    keys[slot] = keys[next];
+    values[slot] = values[next];
+    slot = next;
+    next = (next + 1) & mask;
+  }
+  keys[slot] = EMPTY;
+  count--;
+
+  return true;
+}
+
+template class BasicFlatHashMap<float>;
+template class BasicFlatHashMap<double>;
+template class BasicFlatHashMap<std::int32_t>;
+template class BasicFlatHashMap<std::int64_t>;
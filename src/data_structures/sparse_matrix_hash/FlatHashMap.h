@@ -0,0 +1,103 @@
+#ifndef MC458_PROJETO_FLATHASHMAP_H
+#define MC458_PROJETO_FLATHASHMAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Tabela hash de endereçamento aberto (Robin Hood com sondagem linear) de chaves (linha, coluna)
+// empacotadas em 64 bits para valores do tipo V. Chaves e valores ficam em vetores contíguos separados,
+// então uma sondagem percorre só o vetor de chaves (8 por linha de cache), sem um nó alocado por elemento.
+// A remoção desloca os elementos seguintes para trás, sem lápides.
+template<typename V>
+class BasicFlatHashMap {
+  static constexpr std::uint64_t EMPTY = ~std::uint64_t{0};
+
+  std::vector<std::uint64_t> keys;
+  std::vector<V> values;
+  size_t count = 0;
+  size_t mask = 0;
+
+  static std::uint64_t mix(std::uint64_t key);
+
+  size_t home(const std::uint64_t key) const {
+    return mix(key) & mask;
+  }
+
+  size_t distance(const size_t slot) const {
+    return (slot - home(keys[slot])) & mask;
+  }
+
+  size_t findSlot(std::uint64_t key) const;
+
+  void rehash(size_t capacity);
+
+public:
+  static std::uint64_t pack(const int i, const int j) {
+    return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(i)) << 32) | static_cast<std::uint32_t>(j);
+  }
+
+  static int row(const std::uint64_t key) {
+    return static_cast<int>(key >> 32);
+  }
+
+  static int column(const std::uint64_t key) {
+    return static_cast<int>(key & 0xFFFFFFFFu);
+  }
+
+  size_t size() const;
+
+  size_t capacity() const;
+
+  bool empty() const;
+
+  void clear();
+
+  void reserve(size_t elements);
+
+  const V *find(std::uint64_t key) const;
+
+  V *find(std::uint64_t key);
+
+  void prefetch(std::uint64_t key) const;
+
+  V &operator[](std::uint64_t key);
+
+  bool erase(std::uint64_t key);
+
+  template<typename Visit>
+  void forEachInSlots(const size_t slotBegin, const size_t slotEnd, Visit &&visit) const {
+    for (size_t slot = slotBegin; slot < slotEnd; slot++) {
+      if (keys[slot] != EMPTY) {
+        visit(keys[slot], values[slot]);
+      }
+    }
+  }
+
+  template<typename Visit>
+  void forEach(Visit &&visit) const {
+    for (size_t slot = 0; slot < keys.size(); slot++) {
+      if (keys[slot] != EMPTY) {
+        visit(keys[slot], values[slot]);
+      }
+    }
+  }
+
+  template<typename Visit>
+  void forEach(Visit &&visit) {
+    for (size_t slot = 0; slot < keys.size(); slot++) {
+      if (keys[slot] != EMPTY) {
+        visit(keys[slot], values[slot]);
+      }
+    }
+  }
+};
+
+extern template class BasicFlatHashMap<float>;
+extern template class BasicFlatHashMap<double>;
+extern template class BasicFlatHashMap<std::int32_t>;
+extern template class BasicFlatHashMap<std::int64_t>;
+
+using FlatHashMap = BasicFlatHashMap<double>;
+
+#endif //MC458_PROJETO_FLATHASHMAP_H
@@ -1,144 +1,502 @@
 #include "SparseMatrixHash.h"
+#include "../sparse_accumulator/SparseAccumulator.h"
+#include "../sparse_matrix_csr/SparseMatrixCSR.h"
+#include "../../parallel/ParallelAccumulate.h"
+#include <algorithm>
 #include <cassert>
+#include <utility>
+
+// Formas comprimidas do armazenamento na orientação guardada (sem a flag transposed), com os valores guardados
+// (sem o fator pendente): por linhas, para percorrer linhas, e por colunas, para percorrer colunas
+template<typename T>
+struct BasicSparseMatrixHash<T>::Index {
+  BasicSparseMatrixCSR<T> rows;
+  BasicSparseMatrixCSR<T> columns;
+};
+
+namespace {
+  // Quantas buscas à frente os lotes pedem as linhas de cache: o bastante para sobrepor as faltas de cache
+  // de buscas independentes sem que as linhas pedidas sejam expulsas antes do uso
+  constexpr size_t PREFETCH_DISTANCE = 16;
+
+  /// @brief Aplica ao resultado de um produto o fator pendente da matriz, em vez de a cada elemento lido
+  template<typename T>
+  void applyScale(std::vector<T> &y, const T scale) {
+    if (scale != T(1)) {
+      for (T &value: y) {
+        value *= scale;
+      }
+    }
+  }
+}
+
+template<typename T>
+BasicSparseMatrixHash<T>::BasicSparseMatrixHash(const int n, const int m, const bool transposed)
+  : n{n}, m{m}, transposed{transposed}, data{std::make_shared<Map>()} {
+}
+
+template<typename T>
+BasicSparseMatrixHash<T>::BasicSparseMatrixHash(const int n, const int m,
+                                                const bool transposed,
+                                                Map d)
+  : n{n}, m{m}, transposed{transposed}, data{std::make_shared<Map>(std::move(d))} {
+}
+
+/// @brief Tabela para escrita: copiada antes se outra matriz (uma cópia ou transposta) a compartilha, e
+///        sem os índices, que deixariam de corresponder a ela
+template<typename T>
+typename BasicSparseMatrixHash<T>::Map &BasicSparseMatrixHash<T>::mutableData() {
+  if (data.use_count() > 1) {
+    data = std::make_shared<Map>(*data);
+  }
+  index.reset();
+  return *data;
+}
+
+template<typename T>
+int BasicSparseMatrixHash<T>::rows() const {
+  return n;
+}
 
-SparseMatrixHash::SparseMatrixHash(const int n, const int m, const bool transposed)
-  : n{n}, m{m}, transposed{transposed} {
+template<typename T>
+int BasicSparseMatrixHash<T>::cols() const {
+  return m;
 }
 
-SparseMatrixHash::SparseMatrixHash(const int n, const int m,
-                                   const bool transposed,
-                                   const std::unordered_map<std::pair<int, int>, double, PairHash> &d)
-  : n{n}, m{m}, transposed{transposed}, data{d} {
+template<typename T>
+size_t BasicSparseMatrixHash<T>::nnz() const {
+  return data->size();
 }
 
-double SparseMatrixHash::get(const int i, const int j) const {
+/// @brief Fator pendente que multiplica todos os valores guardados
+template<typename T>
+T BasicSparseMatrixHash<T>::scaleFactor() const {
+  return scale;
+}
+
+/// @brief Aplica o fator pendente aos valores guardados, numa passada, e volta o fator a 1
+template<typename T>
+void BasicSparseMatrixHash<T>::materialize() {
+  if (scale == T(1)) {
+    return;
+  }
+  mutableData().forEach([alpha = scale](std::uint64_t, T &value) {
+    value *= alpha;
+  });
+  scale = T(1);
+}
+
+template<typename T>
+T BasicSparseMatrixHash<T>::get(const int i, const int j) const {
   const auto k = key(i, j);
-  const auto it = data.find(k);
-  return it == data.end() ? 0.0 : it->second;
+  const T *value = data->find(k);
+  return value == nullptr ? T{} : scale * *value;
 }
 
-void SparseMatrixHash::set(const int i, const int j, const double value) {
+template<typename T>
+void BasicSparseMatrixHash<T>::set(const int i, const int j, const T value) {
+  materialize();
   const auto k = key(i, j);
-  if (value == 0.0)
-    data.erase(k);
+  if (value == T{})
+    mutableData().erase(k);
   else
-    data[k] = value;
+    mutableData()[k] = value;
+}
+
+/// @brief Lê count posições de uma vez: enquanto resolve uma busca já pediu as posições iniciais das
+///        PREFETCH_DISTANCE seguintes, então as faltas de cache de buscas independentes se sobrepõem em vez de
+///        se somarem
+/// @param positions coordenadas (linha, coluna) a ler
+/// @param values recebe os count valores lidos, na ordem das posições
+template<typename T>
+void BasicSparseMatrixHash<T>::getBatch(const std::pair<int, int> *positions, const size_t count, T *values) const {
+  for (size_t t = 0; t < std::min(count, PREFETCH_DISTANCE); t++) {
+    data->prefetch(key(positions[t].first, positions[t].second));
+  }
+  for (size_t t = 0; t < count; t++) {
+    if (t + PREFETCH_DISTANCE < count) {
+      const auto &ahead = positions[t + PREFETCH_DISTANCE];
+      data->prefetch(key(ahead.first, ahead.second));
+    }
+    const T *value = data->find(key(positions[t].first, positions[t].second));
+    values[t] = value == nullptr ? T{} : scale * *value;
+  }
+}
+
+/// @brief Escreve count valores com o mesmo encadeamento de getBatch; equivale a set em cada posição, na
+///        ordem dada
+template<typename T>
+void BasicSparseMatrixHash<T>::setBatch(const std::pair<int, int> *positions, const T *values, const size_t count) {
+  materialize();
+  Map &map = mutableData();
+  for (size_t t = 0; t < std::min(count, PREFETCH_DISTANCE); t++) {
+    map.prefetch(key(positions[t].first, positions[t].second));
+  }
+  for (size_t t = 0; t < count; t++) {
+    if (t + PREFETCH_DISTANCE < count) {
+      const auto &ahead = positions[t + PREFETCH_DISTANCE];
+      map.prefetch(key(ahead.first, ahead.second));
+    }
+    const auto k = key(positions[t].first, positions[t].second);
+    if (values[t] == T{})
+      map.erase(k);
+    else
+      map[k] = values[t];
+  }
 }
 
-SparseMatrixHash SparseMatrixHash::transpose() const {
-  return SparseMatrixHash(m, n, !transposed, {});
+/// @brief Transposta em O(1): compartilha a tabela e os índices, só com a flag transposed trocada.
+///        Escritas em qualquer uma das duas copiam a tabela antes
+template<typename T>
+BasicSparseMatrixHash<T> BasicSparseMatrixHash<T>::transpose() const {
+  BasicSparseMatrixHash C = *this;
+  C.transposeSelf();
+  return C;
 }
 
-void SparseMatrixHash::transposeSelf() {
+template<typename T>
+void BasicSparseMatrixHash<T>::transposeSelf() {
+  std::swap(n, m);
   transposed = !transposed;
 }
 
-std::vector<std::tuple<int, int, double> > SparseMatrixHash::items() const {
-  std::vector<std::tuple<int, int, double> > items;
-  items.reserve(data.size());
+/// @brief Constrói as formas comprimidas por linha e por coluna do armazenamento, em O(k log k). Ficam
+///        válidas, e compartilhadas por cópias e transpostas, até a próxima escrita na tabela
+template<typename T>
+void BasicSparseMatrixHash<T>::buildIndex() {
+  using CSR = BasicSparseMatrixCSR<T>;
+
+  std::vector<std::tuple<int, int, T> > entries;
+  entries.reserve(data->size());
+  data->forEach([&](const std::uint64_t key, const T value) {
+    entries.emplace_back(Map::row(key), Map::column(key), value);
+  });
+
+  const int storedRows = transposed ? m : n;
+  const int storedCols = transposed ? n : m;
+  const CSR rows = CSR::fromTriplets(storedRows, storedCols, entries);
+  index = std::make_shared<const Index>(Index{rows, rows.toColumnMajor()});
+}
+
+template<typename T>
+bool BasicSparseMatrixHash<T>::indexed() const {
+  return index != nullptr;
+}
+
+/// @brief Forma comprimida da matriz lógica, por linhas ou por colunas. Com os índices é O(1) (ou O(k) se
+///        há fator pendente): a transposta de uma forma por colunas é a forma por linhas da transposta
+template<typename T>
+BasicSparseMatrixCSR<T> BasicSparseMatrixHash<T>::toCompressed(const bool byColumn) const {
+  using CSR = BasicSparseMatrixCSR<T>;
 
-  for (const auto &[key, value]: data) {
+  if (!index) {
+    const CSR C = CSR::fromTriplets(n, m, items());
+    return byColumn ? C.toColumnMajor() : C;
+  }
+
+  const CSR &stored = byColumn != transposed ? index->columns : index->rows;
+  const CSR C = transposed ? stored.transpose() : stored;
+  return scale == T(1) ? C : C.scalarMult(scale);
+}
+
+template<typename T>
+std::vector<std::tuple<int, int, T> > BasicSparseMatrixHash<T>::items() const {
+  std::vector<std::tuple<int, int, T> > items;
+  items.reserve(data->size());
+
+  data->forEach([&](const std::uint64_t key, const T stored) {
+    const T value = scale * stored;
     if (!transposed) {
-      items.emplace_back(key.first, key.second, value);
+      items.emplace_back(Map::row(key), Map::column(key), value);
     } else {
-      items.emplace_back(key.second, key.first, value);
+      items.emplace_back(Map::column(key), Map::row(key), value);
     }
-  }
+  });
 
   return items;
 }
 
-SparseMatrixHash SparseMatrixHash::add(const SparseMatrixHash &B) const {
-  assert(n == B.n && m == B.m);
+/// @brief Linha (logicalRow) ou coluna da matriz lógica como (índice, valor) ordenados por índice. Com os
+///        índices é O(saída), lida da forma comprimida na orientação guardada; sem eles percorre a tabela
+template<typename T>
+std::vector<std::pair<int, T> > BasicSparseMatrixHash<T>::line(const bool logicalRow, const int position) const {
+  std::vector<std::pair<int, T> > entries;
+  const bool storedRow = logicalRow != transposed;
+
+  if (index) {
+    const auto slice = storedRow ? index->rows.row(position) : index->columns.col(position);
+    entries.reserve(slice.size);
+    for (int p = 0; p < slice.size; p++) {
+      entries.emplace_back(slice.index[p], scale * slice.value[p]);
+    }
+    return entries;
+  }
 
-  SparseMatrixHash C(n, m);
-  C.data = this->data;
+  data->forEach([&](const std::uint64_t key, const T value) {
+    if ((storedRow ? Map::row(key) : Map::column(key)) == position) {
+      entries.emplace_back(storedRow ? Map::column(key) : Map::row(key), scale * value);
+    }
+  });
+  std::sort(entries.begin(), entries.end(), [](const auto &x, const auto &y) { return x.first < y.first; });
+  return entries;
+}
 
-  for (auto [i, j, value]: B.items()) {
-    std::pair key{i, j};
-    C.data[key] += value;
+template<typename T>
+std::vector<std::pair<int, T> > BasicSparseMatrixHash<T>::row(const int i) const {
+  assert(0 <= i && i < n);
+  return line(true, i);
+}
 
-    if (C.data[key] == 0.0) {
-      C.data.erase(key);
+template<typename T>
+std::vector<std::pair<int, T> > BasicSparseMatrixHash<T>::col(const int j) const {
+  assert(0 <= j && j < m);
+  return line(false, j);
+}
+
+/// @brief Bloco [r0, r1) x [c0, c1) com índices a partir de (r0, c0), com o mesmo fator pendente. Com os
+///        índices cada linha do bloco é localizada por busca binária, O(linhas * log + saída); sem eles a
+///        tabela inteira é percorrida
+template<typename T>
+BasicSparseMatrixHash<T> BasicSparseMatrixHash<T>::submatrix(const int r0, const int r1, const int c0,
+                                                             const int c1) const {
+  assert(0 <= r0 && r0 <= r1 && r1 <= n && 0 <= c0 && c0 <= c1 && c1 <= m);
+
+  BasicSparseMatrixHash C(r1 - r0, c1 - c0);
+  Map &map = C.mutableData();
+  C.scale = scale;
+
+  if (index) {
+    // Com a flag transposed o bloco lógico é o bloco transposto do armazenamento
+    const auto &stored = transposed ? index->rows.submatrix(c0, c1, r0, r1).transpose()
+                                    : index->rows.submatrix(r0, r1, c0, c1);
+    for (const auto &[i, j, value]: stored.items()) {
+      map[Map::pack(i, j)] = value;
     }
+    return C;
   }
+
+  data->forEach([&](const std::uint64_t key, const T value) {
+    const int i = transposed ? Map::column(key) : Map::row(key);
+    const int j = transposed ? Map::row(key) : Map::column(key);
+    if (r0 <= i && i < r1 && c0 <= j && j < c1) {
+      map[Map::pack(i - r0, j - c0)] = value;
+    }
+  });
+  return C;
+}
+
+template<typename T>
+BasicSparseMatrixHash<T> BasicSparseMatrixHash<T>::add(const BasicSparseMatrixHash &B) const {
+  assert(n == B.n && m == B.m);
+
+  BasicSparseMatrixHash C = *this;
+  C.addInPlace(B);
   return C;
 }
 
-void SparseMatrixHash::addInPlace(const SparseMatrixHash &B) {
+template<typename T>
+void BasicSparseMatrixHash<T>::addInPlace(const BasicSparseMatrixHash &B) {
   assert(n == B.n && m == B.m);
 
-  for (auto [i, j, value]: B.items()) {
-    std::pair key{i, j};
-    data[key] += value;
+  materialize();
+  const std::vector<std::tuple<int, int, T> > entries = B.items();
+  Map &map = mutableData();
+  map.reserve(map.size() + entries.size());
 
-    if (data[key] == 0.0) {
-      data.erase(key);
+  for (auto [i, j, value]: entries) {
+    const auto k = key(i, j);
+    T &sum = map[k];
+    sum += value;
+
+    if (sum == T{}) {
+      map.erase(k);
     }
   }
 }
 
-SparseMatrixHash &SparseMatrixHash::operator+=(const SparseMatrixHash &B) {
+template<typename T>
+BasicSparseMatrixHash<T> &BasicSparseMatrixHash<T>::operator+=(const BasicSparseMatrixHash &B) {
   addInPlace(B);
   return *this;
 }
 
-SparseMatrixHash SparseMatrixHash::scalarMult(const double alpha) const {
-  if (alpha == 0.0) {
-    return SparseMatrixHash(n, m);
-  }
-
-  SparseMatrixHash C(n, m, transposed, {});
-
-  for (const auto [key, value]: data) {
-    C.data[key] = alpha * value;
+template<typename T>
+BasicSparseMatrixHash<T> BasicSparseMatrixHash<T>::scalarMult(const T alpha) const {
+  if (alpha == T{}) {
+    return BasicSparseMatrixHash(n, m);
   }
 
+  BasicSparseMatrixHash C = *this;
+  C.scalarMultInPlace(alpha);
   return C;
 }
 
-void SparseMatrixHash::scalarMultInPlace(const double alpha) {
-  if (alpha == 0.0) {
-    data.clear();
+/// @brief Multiplicação por escalar em O(1), acumulada no fator pendente; por zero, troca a tabela por uma
+///        vazia, sem copiar antes a que outra matriz possa compartilhar
+template<typename T>
+void BasicSparseMatrixHash<T>::scalarMultInPlace(const T alpha) {
+  if (alpha == T{}) {
+    data = std::make_shared<Map>();
+    index.reset();
+    scale = T(1);
     return;
   }
 
-  for (auto &[_, value]: data) {
-    value *= alpha;
-  }
+  scale *= alpha;
 }
 
-SparseMatrixHash &SparseMatrixHash::operator*=(const double alpha) {
+template<typename T>
+BasicSparseMatrixHash<T> &BasicSparseMatrixHash<T>::operator*=(const T alpha) {
   scalarMultInPlace(alpha);
   return *this;
 }
 
-SparseMatrixHash SparseMatrixHash::mult(const SparseMatrixHash &B) const {
+template<typename T>
+BasicSparseMatrixHash<T> BasicSparseMatrixHash<T>::mult(const BasicSparseMatrixHash &B) const {
   assert(m == B.n);
 
-  SparseMatrixHash C(n, B.m);
+  using CSR = BasicSparseMatrixCSR<T>;
+  const CSR a = CSR::fromHash(*this);
+  const CSR b = CSR::fromHash(B);
+  SparseAccumulator<T> accumulator(B.m);
 
-  std::unordered_map<int, std::vector<std::pair<int, double> > > Brow;
+  std::vector<std::tuple<int, int, T> > result;
 
-  for (auto [i, j, value]: B.items()) {
-    Brow[i].emplace_back(j, value);
+  for (int i = 0; i < n; i++) {
+    const typename CSR::Slice aRow = a.row(i);
+
+    for (int p = 0; p < aRow.size; p++) {
+      const typename CSR::Slice bRow = b.row(aRow.index[p]);
+      const T aValue = aRow.value[p];
+
+      for (int q = 0; q < bRow.size; q++) {
+        accumulator.add(bRow.index[q], aValue * bRow.value[q]);
+      }
+    }
+
+    accumulator.flush(false, [&](const int j, const T value) {
+      result.emplace_back(i, j, value);
+    });
+  }
+
+  BasicSparseMatrixHash C(n, B.m);
+  Map &map = C.mutableData();
+  map.reserve(result.size());
+  for (const auto &[i, j, value]: result) {
+    map[C.key(i, j)] = value;
   }
 
-  for (auto [i, k, aValue]: this->items()) {
-    if (!Brow.count(k)) continue;
+  return C;
+}
 
-    for (auto &[j, bValue]: Brow[k]) {
-      const double old = C.get(i, j);
-      C.set(i, j, old + aValue * bValue);
+template<typename T>
+BasicSparseMatrixHash<T> BasicSparseMatrixHash<T>::multParallel(const BasicSparseMatrixHash &B,
+                                                                ThreadPool &pool) const {
+  assert(m == B.n);
+
+  using CSR = BasicSparseMatrixCSR<T>;
+  const CSR product = CSR::fromHash(*this).multParallel(CSR::fromHash(B), pool);
+
+  BasicSparseMatrixHash C(n, B.m);
+  Map &map = C.mutableData();
+  map.reserve(product.nnz());
+  for (int i = 0; i < n; i++) {
+    const typename CSR::Slice row = product.row(i);
+    for (int p = 0; p < row.size; p++) {
+      map[C.key(i, row.index[p])] = row.value[p];
     }
   }
 
   return C;
 }
 
-std::ostream &operator<<(std::ostream &os, const SparseMatrixHash &M) {
+template<typename T>
+void BasicSparseMatrixHash<T>::product(const bool transpose, const T *x, T *y, const int width,
+                                       ThreadPool *pool) const {
+  const bool swap = transposed != transpose;
+
+  const auto accumulate = [&](T *target, const size_t slotBegin, const size_t slotEnd) {
+    data->forEachInSlots(slotBegin, slotEnd, [&](const std::uint64_t key, const T value) {
+      const int i = swap ? Map::column(key) : Map::row(key);
+      const int j = swap ? Map::row(key) : Map::column(key);
+      const T *__restrict source = x + static_cast<size_t>(j) * width;
+      T *__restrict output = target + static_cast<size_t>(i) * width;
+      for (int c = 0; c < width; c++) {
+        output[c] += value * source[c];
+      }
+    });
+  };
+
+  if (pool == nullptr || pool->size() == 1) {
+    accumulate(y, 0, data->capacity());
+    return;
+  }
+
+  const int tasks = pool->size();
+  const size_t step = (data->capacity() + tasks - 1) / tasks;
+  const size_t outputs = static_cast<size_t>(transpose ? m : n) * width;
+  parallelAccumulate(*pool, tasks, outputs, y, [&](const int t, T *local) {
+    const size_t slotBegin = std::min(data->capacity(), t * step);
+    accumulate(local, slotBegin, std::min(data->capacity(), slotBegin + step));
+  });
+}
+
+template<typename T>
+std::vector<T> BasicSparseMatrixHash<T>::multVector(const std::vector<T> &x, const bool transpose) const {
+  assert(x.size() == static_cast<size_t>(transpose ? n : m));
+
+  std::vector<T> y(transpose ? m : n, T{});
+  product(transpose, x.data(), y.data(), 1, nullptr);
+  applyScale(y, scale);
+  return y;
+}
+
+template<typename T>
+std::vector<T> BasicSparseMatrixHash<T>::multVectorParallel(const std::vector<T> &x, const bool transpose,
+                                                            ThreadPool &pool) const {
+  assert(x.size() == static_cast<size_t>(transpose ? n : m));
+
+  std::vector<T> y(transpose ? m : n, T{});
+  product(transpose, x.data(), y.data(), 1, &pool);
+  applyScale(y, scale);
+  return y;
+}
+
+template<typename T>
+BasicDenseMatrix<T> BasicSparseMatrixHash<T>::multDense(const BasicDenseMatrix<T> &X, const bool transpose) const {
+  assert(X.rows() == (transpose ? n : m));
+
+  BasicDenseMatrix<T> Y(transpose ? m : n, X.cols());
+  product(transpose, X.rowData(0), Y.rowData(0), X.cols(), nullptr);
+  Y *= scale * X.scaleFactor();
+  return Y;
+}
+
+template<typename T>
+BasicDenseMatrix<T> BasicSparseMatrixHash<T>::multDenseParallel(const BasicDenseMatrix<T> &X, const bool transpose,
+                                                                ThreadPool &pool) const {
+  assert(X.rows() == (transpose ? n : m));
+
+  BasicDenseMatrix<T> Y(transpose ? m : n, X.cols());
+  product(transpose, X.rowData(0), Y.rowData(0), X.cols(), &pool);
+  Y *= scale * X.scaleFactor();
+  return Y;
+}
+
+template<typename T>
+std::ostream &operator<<(std::ostream &os, const BasicSparseMatrixHash<T> &M) {
   os << "SparseMatrixHash(" << M.n << "x" << M.m
-      << ", nnz=" << M.data.size()
+      << ", nnz=" << M.data->size()
       << ", transposed=" << (M.transposed ? "true" : "false") << ")";
   return os;
 }
+
+template class BasicSparseMatrixHash<float>;
+template class BasicSparseMatrixHash<double>;
+template class BasicSparseMatrixHash<std::int32_t>;
+template class BasicSparseMatrixHash<std::int64_t>;
+
+template std::ostream &operator<<(std::ostream &os, const BasicSparseMatrixHash<float> &M);
+template std::ostream &operator<<(std::ostream &os, const BasicSparseMatrixHash<double> &M);
+template std::ostream &operator<<(std::ostream &os, const BasicSparseMatrixHash<std::int32_t> &M);
+template std::ostream &operator<<(std::ostream &os, const BasicSparseMatrixHash<std::int64_t> &M);
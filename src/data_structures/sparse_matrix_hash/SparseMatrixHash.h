@@ -1,61 +1,132 @@
 #ifndef MC458_PROJETO_SPARSEMATRIXHASH_H
 #define MC458_PROJETO_SPARSEMATRIXHASH_H
 
-#include <unordered_map>
+#include <cstdint>
+#include <memory>
 #include <vector>
 #include <tuple>
-#include <iostream>
 #include <utility>
+#include <iostream>
 
-struct PairHash {
-  size_t operator()(const std::pair<int, int> &p) const {
-    return std::hash<long long>()(
-      (static_cast<long long>(p.first) << 32) ^ p.second
-    );
-  }
-};
+#include "FlatHashMap.h"
+#include "../dense_matrix/DenseMatrix.h"
+#include "../../parallel/ThreadPool.h"
+
+template<typename T>
+class BasicSparseMatrixCSR;
+
+// Matriz esparsa em tabela hash com elementos do tipo T, instanciada em SparseMatrixHash.cpp para float,
+// double, int32_t e int64_t; SparseMatrixHash é a forma com double.
+// Assim como a transposição troca só a flag transposed, a multiplicação por escalar só acumula o fator
+// pendente scale, aplicado por quem lê os valores e, de uma vez, antes da primeira escrita.
+// Cópias e transpostas compartilham a tabela até a primeira escrita em uma delas (cópia na escrita), e
+// buildIndex acrescenta formas comprimidas por linha e por coluna, também compartilhadas, que tornam
+// A^T * B e o acesso a colunas proporcionais aos elementos envolvidos
+template<typename T>
+class BasicSparseMatrixHash {
+  using Map = BasicFlatHashMap<T>;
+
+  struct Index;
 
-class SparseMatrixHash {
   int n, m;
   bool transposed;
-  std::unordered_map<std::pair<int, int>, double, PairHash> data;
+  T scale = T(1);
+  std::shared_ptr<Map> data;
+  std::shared_ptr<const Index> index;
 
-  std::pair<int, int> key(int i, int j) const {
-    return transposed ? std::pair{j, i} : std::pair{i, j};
+  std::uint64_t key(int i, int j) const {
+    return transposed ? Map::pack(j, i) : Map::pack(i, j);
   }
 
+  void product(bool transpose, const T *x, T *y, int width, ThreadPool *pool) const;
+
+  void materialize();
+
+  Map &mutableData();
+
+  std::vector<std::pair<int, T> > line(bool logicalRow, int position) const;
+
 public:
-  SparseMatrixHash(int n, int m, bool transposed = false);
+  using Value = T;
+
+  BasicSparseMatrixHash(int n, int m, bool transposed = false);
+
+  BasicSparseMatrixHash(int n, int m,
+                        bool transposed,
+                        Map d);
+
+  int rows() const;
+
+  int cols() const;
+
+  size_t nnz() const;
 
-  SparseMatrixHash(int n, int m,
-                   bool transposed,
-                   const std::unordered_map<std::pair<int, int>, double, PairHash> &d);
+  T scaleFactor() const;
 
-  double get(int i, int j) const;
+  void buildIndex();
 
-  void set(int i, int j, double value);
+  bool indexed() const;
 
-  SparseMatrixHash transpose() const;
+  BasicSparseMatrixCSR<T> toCompressed(bool byColumn = false) const;
+
+  T get(int i, int j) const;
+
+  void set(int i, int j, T value);
+
+  void getBatch(const std::pair<int, int> *positions, size_t count, T *values) const;
+
+  void setBatch(const std::pair<int, int> *positions, const T *values, size_t count);
+
+  BasicSparseMatrixHash transpose() const;
 
   void transposeSelf();
 
-  std::vector<std::tuple<int, int, double> > items() const;
+  std::vector<std::tuple<int, int, T> > items() const;
+
+  std::vector<std::pair<int, T> > row(int i) const;
+
+  std::vector<std::pair<int, T> > col(int j) const;
+
+  BasicSparseMatrixHash submatrix(int r0, int r1, int c0, int c1) const;
 
-  SparseMatrixHash add(const SparseMatrixHash &B) const;
+  BasicSparseMatrixHash add(const BasicSparseMatrixHash &B) const;
 
-  void addInPlace(const SparseMatrixHash &B);
+  void addInPlace(const BasicSparseMatrixHash &B);
 
-  SparseMatrixHash &operator+=(const SparseMatrixHash &B);
+  BasicSparseMatrixHash &operator+=(const BasicSparseMatrixHash &B);
 
-  SparseMatrixHash scalarMult(double alpha) const;
+  BasicSparseMatrixHash scalarMult(T alpha) const;
 
-  void scalarMultInPlace(double alpha);
+  void scalarMultInPlace(T alpha);
 
-  SparseMatrixHash &operator*=(double alpha);
+  BasicSparseMatrixHash &operator*=(T alpha);
 
-  SparseMatrixHash mult(const SparseMatrixHash &B) const;
+  BasicSparseMatrixHash mult(const BasicSparseMatrixHash &B) const;
 
-  friend std::ostream &operator<<(std::ostream &os, const SparseMatrixHash &M);
+  BasicSparseMatrixHash multParallel(const BasicSparseMatrixHash &B, ThreadPool &pool = ThreadPool::shared()) const;
+
+  std::vector<T> multVector(const std::vector<T> &x, bool transpose = false) const;
+
+  std::vector<T> multVectorParallel(const std::vector<T> &x, bool transpose = false,
+                                    ThreadPool &pool = ThreadPool::shared()) const;
+
+  BasicDenseMatrix<T> multDense(const BasicDenseMatrix<T> &X, bool transpose = false) const;
+
+  BasicDenseMatrix<T> multDenseParallel(const BasicDenseMatrix<T> &X, bool transpose = false,
+                                        ThreadPool &pool = ThreadPool::shared()) const;
+
+  template<typename U>
+  friend std::ostream &operator<<(std::ostream &os, const BasicSparseMatrixHash<U> &M);
 };
 
+template<typename T>
+std::ostream &operator<<(std::ostream &os, const BasicSparseMatrixHash<T> &M);
+
+extern template class BasicSparseMatrixHash<float>;
+extern template class BasicSparseMatrixHash<double>;
+extern template class BasicSparseMatrixHash<std::int32_t>;
+extern template class BasicSparseMatrixHash<std::int64_t>;
+
+using SparseMatrixHash = BasicSparseMatrixHash<double>;
+
 #endif //MC458_PROJETO_SPARSEMATRIXHASH_H
@@ -1,6 +1,67 @@
 #include "SparseMatrixTree.h"
+#include "../sparse_accumulator/SparseAccumulator.h"
+#include "../sparse_matrix_csr/SparseMatrixCSR.h"
+#include "../../parallel/ParallelAccumulate.h"
 
+#include <algorithm>
+#include <cassert>
+#include <climits>
 #include <iostream>
+#include <new>
+
+namespace {
+  // Quantas descidas findBatch intercala: cada rodada pede ao processador o próximo nó de todas elas, então
+  // até FIND_GROUP faltas de cache ficam em andamento ao mesmo tempo
+  constexpr size_t FIND_GROUP = 16;
+
+  /// @brief Percorre a árvore em ordem simétrica chamando visit(nó), sem alterá-la
+  template<typename Node, typename Visit>
+  void visitInorder(const Node *node, Visit &&visit) {
+    while (node) {
+      visitInorder(node->left, visit);
+      visit(node);
+      node = node->right;
+    }
+  }
+
+  /// @brief Percorre em ordem simétrica só os nós com (linha, coluna) guardadas entre lo e hi, inclusive,
+  ///        descendo apenas pelos ramos que podem conter essas chaves: O(log k + nós visitados)
+  template<typename Node, typename Visit>
+  void visitRange(const Node *node, const std::pair<int, int> &lo, const std::pair<int, int> &hi, Visit &&visit) {
+    while (node) {
+      const std::pair<int, int> key{node->row, node->column};
+      if (key < lo) {
+        node = node->right;
+        continue;
+      }
+      if (hi < key) {
+        node = node->left;
+        continue;
+      }
+      visitRange(node->left, lo, hi, visit);
+      visit(node);
+      node = node->right;
+    }
+  }
+
+  /// @brief Elementos de uma linha guardada (byRow) ou de uma coluna guardada, como (índice na outra
+  ///        dimensão guardada, valor) em ordem crescente. A linha é uma faixa contígua da ordem da árvore e
+  ///        custa O(log k + saída); a coluna percorre todos os nós
+  template<typename Node, typename T>
+  void storedLine(const Node *root, const bool byRow, const int index, std::vector<std::pair<int, T> > &entries) {
+    if (byRow) {
+      visitRange(root, {index, INT_MIN}, {index, INT_MAX}, [&](const Node *node) {
+        entries.emplace_back(node->column, node->value);
+      });
+    } else {
+      visitInorder(root, [&](const Node *node) {
+        if (node->column == index) {
+          entries.emplace_back(node->row, node->value);
+        }
+      });
+    }
+  }
+}
 
 // Estrutura 2: Árvore binária com cada nó tendo o número em si e a sua posição numa matriz
 
@@ -15,14 +76,81 @@
 /// @param l filho esquerdo
 /// @param r filho direito
 /// @param p pai
-SparseMatrixTree::TreeNode::TreeNode(int v, int rw, int col, Color clr, TreeNode *l, TreeNode *r, TreeNode *p)
+template<typename T>
+BasicSparseMatrixTree<T>::TreeNode::TreeNode(T v, int rw, int col, Color clr, TreeNode *l, TreeNode *r, TreeNode *p)
   : value(v), row(rw), column(col), color(clr), left(l), right(r), parent(p) {
 }
 
-/// @brief Destructor da memória
-SparseMatrixTree::TreeNode::~TreeNode() {
-  delete(left);
-  delete(right);
+/// @brief Destructor da arena: libera todos os blocos de uma vez, sem percorrer as árvores
+template<typename T>
+BasicSparseMatrixTree<T>::NodeArena::~NodeArena() {
+  clear();
+}
+
+/// @brief Aloca um nó, reaproveitando a lista livre ou a próxima posição do bloco atual
+/// @return nó construído
+template<typename T>
+typename BasicSparseMatrixTree<T>::TreeNode *
+BasicSparseMatrixTree<T>::NodeArena::create(T v, int rw, int col, Color clr) {
+  TreeNode *node;
+  if (freeList) {
+    node = freeList;
+    freeList = freeList->left;
+  } else {
+    if (used == SLAB_NODES) {
+      slabs.push_back(static_cast<TreeNode *>(::operator new(SLAB_NODES * sizeof(TreeNode))));
+      used = 0;
+    }
+    node = slabs.back() + used++;
+  }
+
+  live++;
+  return new(node) TreeNode(v, rw, col, clr);
+}
+
+/// @brief Devolve um único nó para a lista livre
+/// @param node nó a ser liberado
+template<typename T>
+void BasicSparseMatrixTree<T>::NodeArena::destroy(TreeNode *node) {
+  node->left = freeList;
+  freeList = node;
+  live--;
+}
+
+/// @brief Libera iterativamente todos os nós de uma subárvore, rotacionando filhos esquerdos para a direita
+///        até cada nó não ter filho esquerdo (sem recursão e sem pilha auxiliar)
+/// @param root raiz da subárvore
+template<typename T>
+void BasicSparseMatrixTree<T>::NodeArena::destroyTree(TreeNode *root) {
+  while (root) {
+    if (TreeNode *left = root->left) {
+      root->left = left->right;
+      left->right = root;
+      root = left;
+    } else {
+      TreeNode *right = root->right;
+      destroy(root);
+      root = right;
+    }
+  }
+}
+
+/// @brief Libera de uma vez todos os nós alocados pela arena
+template<typename T>
+void BasicSparseMatrixTree<T>::NodeArena::clear() {
+  for (TreeNode *slab: slabs) {
+    ::operator delete(slab);
+  }
+  slabs.clear();
+  used = SLAB_NODES;
+  freeList = nullptr;
+  live = 0;
+}
+
+/// @brief Número de nós vivos na arena
+template<typename T>
+size_t BasicSparseMatrixTree<T>::NodeArena::size() const {
+  return live;
 }
 
 /// @brief Função auxiliar que realiza comparações de nós a partir de coordenadas da matriz
@@ -31,7 +159,8 @@ SparseMatrixTree::TreeNode::~TreeNode() {
 /// @param i2 linha dp e 2
 /// @param j2 coluna da matriz 2
 /// @return verdadeiro, se o elemento da
-bool SparseMatrixTree::isLessThan(int i1, int j1, int i2, int j2) {
+template<typename T>
+bool BasicSparseMatrixTree<T>::isLessThan(int i1, int j1, int i2, int j2) {
   if (i1 < i2) {
     return true;
   } else if (i1 == i2) {
@@ -44,7 +173,8 @@ bool SparseMatrixTree::isLessThan(int i1, int j1, int i2, int j2) {
 /// @brief Função que verifica se um nó é vermelho
 /// @param node nó a ser verificado
 /// @return verdadeiro se for vermelho, falso caso contrário
-bool SparseMatrixTree::isRed(const TreeNode *node) {
+template<typename T>
+bool BasicSparseMatrixTree<T>::isRed(const TreeNode *node) {
   if (node == nullptr) {
     return false;
   }
@@ -54,7 +184,8 @@ bool SparseMatrixTree::isRed(const TreeNode *node) {
 /// @brief Função que verifica se um nó é preto
 /// @param node nó a ser verificado
 /// @return verdadeiro se for preto, falso caso contrário
-bool SparseMatrixTree::isBlack(const TreeNode *node) {
+template<typename T>
+bool BasicSparseMatrixTree<T>::isBlack(const TreeNode *node) {
   if (node == nullptr) {
     return true;
   }
@@ -65,7 +196,9 @@ bool SparseMatrixTree::isBlack(const TreeNode *node) {
 /// @brief Função de rotação para esquerda da árvore para balanceamento da árvore rubronegra
 /// @param root nó raíz da rotação
 /// @return árvore rotacionada
-SparseMatrixTree::TreeNode *SparseMatrixTree::rotateLeft(TreeNode *root) {
+template<typename T>
+typename BasicSparseMatrixTree<T>::TreeNode *
+BasicSparseMatrixTree<T>::rotateLeft(TreeNode *root) {
   TreeNode *node = root->right;
   root->right = node->left;
   node->left = root;
@@ -77,7 +210,9 @@ SparseMatrixTree::TreeNode *SparseMatrixTree::rotateLeft(TreeNode *root) {
 /// @brief Função de rotação para direita da árvore para balanceamento da árvore rubronegra
 /// @param root nó raíz da rotação
 /// @return árvore rotacionada
-SparseMatrixTree::TreeNode *SparseMatrixTree::rotateRight(TreeNode *root) {
+template<typename T>
+typename BasicSparseMatrixTree<T>::TreeNode *
+BasicSparseMatrixTree<T>::rotateRight(TreeNode *root) {
   TreeNode *node = root->left;
   root->left = node->right;
   node->right = root;
@@ -88,29 +223,36 @@ SparseMatrixTree::TreeNode *SparseMatrixTree::rotateRight(TreeNode *root) {
 
 /// @brief Função auxiliar da árvore rubronegra que sobe a cor vermelha para o nó pai e desce a cor preta para nós filhos
 /// @param root nó raíz da subida de cor
-void SparseMatrixTree::riseRed(TreeNode *root) {
+template<typename T>
+void BasicSparseMatrixTree<T>::riseRed(TreeNode *root) {
   root->color = RED;
   root->left->color = BLACK;
   root->right->color = BLACK;
 }
 
 /// @brief Função de inserção na árvore rubronegra
+/// @param arena arena de onde o novo nó é alocado
 /// @param root nó atual
 /// @param i valor de linha para o novo nó a ser inserido
 /// @param j valor de coluna para o novo nó a ser inserido
 /// @param valueToInsert valor do dado para o novo nó a ser inserido
 /// @return árvore com novo nó inserido ou atualizado
-SparseMatrixTree::TreeNode *SparseMatrixTree::insertRBTree(TreeNode *root, int i, int j, int valueToInsert) {
+template<typename T>
+typename BasicSparseMatrixTree<T>::TreeNode *
+BasicSparseMatrixTree<T>::insertRBTree(NodeArena &arena, TreeNode *root, int i, int j, T valueToInsert) {
   if (root == nullptr) {
-    TreeNode *node = nullptr;
-    node = new TreeNode(valueToInsert, i, j, RED);
-    return node;
+    return arena.create(valueToInsert, i, j, RED);
+  }
+
+  if (i == root->row && j == root->column) {
+    root->value = valueToInsert;
+    return root;
   }
 
   if (isLessThan(i, j, root->row, root->column)) {
-    root->left = insertRBTree(root->left, i, j, valueToInsert);
+    root->left = insertRBTree(arena, root->left, i, j, valueToInsert);
   } else {
-    root->right = insertRBTree(root->right, i, j, valueToInsert);
+    root->right = insertRBTree(arena, root->right, i, j, valueToInsert);
   }
 
   if (isRed(root->right) && isBlack(root->left)) {
@@ -127,34 +269,373 @@ SparseMatrixTree::TreeNode *SparseMatrixTree::insertRBTree(TreeNode *root, int i
 }
 
 
-/// @brief Função wrapper para inserção da árvore rubronegra
+/// @brief Função wrapper para inserção da árvore rubronegra. Uma coordenada já presente tem o valor atualizado,
+///        sem um segundo nó
+/// @param arena arena dona dos nós da árvore
 /// @param root nó raiz
 /// @param i valor de linha do novo nó
 /// @param j valor de coluna do novo nó
 /// @param valueToInsert valor do novo nó
 /// @return árvore com o novo nó inserido
-SparseMatrixTree::TreeNode *SparseMatrixTree::insert(TreeNode *root, int i, int j, int valueToInsert) {
-  root = insertRBTree(root, i, j, valueToInsert);
+template<typename T>
+typename BasicSparseMatrixTree<T>::TreeNode *
+BasicSparseMatrixTree<T>::insert(NodeArena &arena, TreeNode *root, int i, int j, T valueToInsert) {
+  root = insertRBTree(arena, root, i, j, valueToInsert);
   root->color = BLACK;
   return root;
 }
 
+/// @brief Função auxiliar da remoção que inverte as cores do nó e dos dois filhos, juntando-os num nó de três
+///        chaves (ou separando-os, o inverso de riseRed)
+/// @param root nó raíz da inversão
+template<typename T>
+void BasicSparseMatrixTree<T>::flipColors(TreeNode *root) {
+  root->color = root->color == RED ? BLACK : RED;
+  root->left->color = root->left->color == RED ? BLACK : RED;
+  root->right->color = root->right->color == RED ? BLACK : RED;
+}
+
+/// @brief Garante, antes de descer à esquerda, que o filho esquerdo ou um neto esquerdo é vermelho,
+///        emprestando um nó do irmão direito quando possível
+template<typename T>
+typename BasicSparseMatrixTree<T>::TreeNode *
+BasicSparseMatrixTree<T>::moveRedLeft(TreeNode *root) {
+  flipColors(root);
+  if (isRed(root->right->left)) {
+    root->right = rotateRight(root->right);
+    root = rotateLeft(root);
+    flipColors(root);
+  }
+  return root;
+}
+
+/// @brief Garante, antes de descer à direita, que o filho direito ou um neto esquerdo dele é vermelho
+template<typename T>
+typename BasicSparseMatrixTree<T>::TreeNode *
+BasicSparseMatrixTree<T>::moveRedRight(TreeNode *root) {
+  flipColors(root);
+  if (isRed(root->left->left)) {
+    root = rotateRight(root);
+    flipColors(root);
+  }
+  return root;
+}
+
+/// @brief Restaura, na volta da remoção, as invariantes da árvore inclinada à esquerda
+template<typename T>
+typename BasicSparseMatrixTree<T>::TreeNode *
+BasicSparseMatrixTree<T>::balance(TreeNode *root) {
+  if (isRed(root->right) && isBlack(root->left)) {
+    root = rotateLeft(root);
+  }
+  if (isRed(root->left) && isRed(root->left->left)) {
+    root = rotateRight(root);
+  }
+  if (isRed(root->left) && isRed(root->right)) {
+    flipColors(root);
+  }
+  return root;
+}
+
+/// @brief Remove o menor nó da subárvore, devolvendo-o para a arena
+template<typename T>
+typename BasicSparseMatrixTree<T>::TreeNode *
+BasicSparseMatrixTree<T>::eraseMin(NodeArena &arena, TreeNode *root) {
+  if (root->left == nullptr) {
+    arena.destroy(root);
+    return nullptr;
+  }
+
+  if (isBlack(root->left) && isBlack(root->left->left)) {
+    root = moveRedLeft(root);
+  }
+  root->left = eraseMin(arena, root->left);
+  return balance(root);
+}
+
+/// @brief Remoção na árvore rubronegra inclinada à esquerda (Sedgewick): a descida mantém o nó atual num nó
+///        de três ou quatro chaves, então a remoção acontece numa folha sem desequilibrar a altura negra.
+///        Um nó interno removido recebe a coordenada e o valor do seu sucessor, cujo nó é o liberado
+/// @param arena arena para onde o nó removido volta
+/// @param root nó atual
+/// @param i linha do elemento removido, que precisa estar na árvore
+/// @param j coluna do elemento removido
+/// @return subárvore sem o elemento
+template<typename T>
+typename BasicSparseMatrixTree<T>::TreeNode *
+BasicSparseMatrixTree<T>::eraseRBTree(NodeArena &arena, TreeNode *root, int i, int j) {
+  if (isLessThan(i, j, root->row, root->column)) {
+    if (isBlack(root->left) && isBlack(root->left->left)) {
+      root = moveRedLeft(root);
+    }
+    root->left = eraseRBTree(arena, root->left, i, j);
+  } else {
+    if (isRed(root->left)) {
+      root = rotateRight(root);
+    }
+    if (i == root->row && j == root->column && root->right == nullptr) {
+      arena.destroy(root);
+      return nullptr;
+    }
+    if (isBlack(root->right) && isBlack(root->right->left)) {
+      root = moveRedRight(root);
+    }
+    if (i == root->row && j == root->column) {
+      const TreeNode *successor = root->right;
+      while (successor->left) {
+        successor = successor->left;
+      }
+      root->row = successor->row;
+      root->column = successor->column;
+      root->value = successor->value;
+      root->right = eraseMin(arena, root->right);
+    } else {
+      root->right = eraseRBTree(arena, root->right, i, j);
+    }
+  }
+  return balance(root);
+}
+
+/// @brief Remove um elemento da árvore em O(log k), devolvendo o nó para a arena. Ponteiros para nós obtidos
+///        antes (por findElement, por exemplo) deixam de valer
+/// @param arena arena dona dos nós da árvore
+/// @param root nó raiz
+/// @param i linha do elemento removido
+/// @param j coluna do elemento removido
+/// @return nova raiz; a árvore não muda se a coordenada não estiver nela
+template<typename T>
+typename BasicSparseMatrixTree<T>::TreeNode *
+BasicSparseMatrixTree<T>::erase(NodeArena &arena, TreeNode *root, int i, int j) {
+  if (findElement(root, i, j, false) == nullptr) {
+    return root;
+  }
+
+  if (isBlack(root->left) && isBlack(root->right)) {
+    root->color = RED;
+  }
+  root = eraseRBTree(arena, root, i, j);
+  if (root) {
+    root->color = BLACK;
+  }
+  return root;
+}
+
+/// @brief Escreve um elemento: atualiza ou insere um valor não nulo e remove a coordenada quando o valor é zero,
+///        então a árvore nunca guarda zeros explícitos
+/// @return nova raiz
+template<typename T>
+typename BasicSparseMatrixTree<T>::TreeNode *
+BasicSparseMatrixTree<T>::set(NodeArena &arena, TreeNode *root, int i, int j, T value) {
+  if (value == T{}) {
+    return erase(arena, root, i, j);
+  }
+  return insert(arena, root, i, j, value);
+}
+
+/// @brief Retira de uma vez os nós com valor zero (deixados, por exemplo, por escritas diretas em node->value):
+///        a árvore é achatada, os zeros voltam para a arena e o restante é religado balanceado, em O(k)
+/// @return nova raiz
+template<typename T>
+typename BasicSparseMatrixTree<T>::TreeNode *
+BasicSparseMatrixTree<T>::pruneZeros(NodeArena &arena, TreeNode *root) {
+  size_t size;
+  TreeNode *list = dropZeros(arena, flatten(root, size), size);
+  return relink(list, size);
+}
+
+/// @brief Número máximo de chaves de uma árvore 2-3 (LLRB) com altura negra h: 3^h - 1
+/// @param blackHeight altura negra
+/// @return tamanho máximo, saturado para alturas grandes
+static long long maxLLRBSize(const int blackHeight) {
+  long long size = 1;
+  for (int h = 0; h < blackHeight && size < (1LL << 60); h++) {
+    size *= 3;
+  }
+  return size - 1;
+}
+
+/// @brief Altura negra da árvore balanceada construída com size elementos
+/// @param size quantidade de elementos
+/// @return menor altura negra h com 2^(h+1) - 1 > size
+static int balancedBlackHeight(const size_t size) {
+  int blackHeight = 0;
+  while ((2ULL << blackHeight) - 1 <= size) {
+    blackHeight++;
+  }
+  return blackHeight;
+}
+
+/// @brief Monta recursivamente uma subárvore rubronegra inclinada à esquerda de altura negra fixa.
+///        Cada nó é um 2-nó (um nó preto) ou, quando os filhos não comportam todas as chaves,
+///        um 3-nó (nó preto com filho esquerdo vermelho). Os nós são pedidos em ordem simétrica
+/// @param size quantidade de elementos
+/// @param blackHeight altura negra da subárvore
+/// @param next função chamada como next(cor), que devolve o próximo nó em ordem já com a cor pedida
+/// @return raiz (preta) da subárvore
+template<typename T>
+template<typename NextNode>
+typename BasicSparseMatrixTree<T>::TreeNode *
+BasicSparseMatrixTree<T>::linkBalanced(const size_t size, const int blackHeight, NextNode &next) {
+  if (size == 0) {
+    return nullptr;
+  }
+
+  const long long childMax = maxLLRBSize(blackHeight - 1);
+
+  if (static_cast<long long>(size - 1) <= 2 * childMax) {
+    const size_t leftSize = (size - 1) / 2;
+    TreeNode *left = linkBalanced(leftSize, blackHeight - 1, next);
+    TreeNode *node = next(BLACK);
+    node->left = left;
+    node->right = linkBalanced(size - 1 - leftSize, blackHeight - 1, next);
+    return node;
+  }
+
+  const size_t rest = size - 2;
+  const size_t size1 = rest / 3;
+  const size_t size2 = (rest - size1) / 2;
+  const size_t size3 = rest - size1 - size2;
+
+  TreeNode *first = linkBalanced(size1, blackHeight - 1, next);
+  TreeNode *red = next(RED);
+  red->left = first;
+  red->right = linkBalanced(size2, blackHeight - 1, next);
+
+  TreeNode *node = next(BLACK);
+  node->left = red;
+  node->right = linkBalanced(size3, blackHeight - 1, next);
+  return node;
+}
+
+/// @brief Constrói em O(k) uma árvore rubronegra balanceada a partir de elementos já ordenados por (linha, coluna)
+/// @param arena arena onde os nós são alocados
+/// @param entries elementos (linha, coluna, valor) em ordem crescente
+/// @return raiz da árvore
+template<typename T>
+typename BasicSparseMatrixTree<T>::TreeNode *
+BasicSparseMatrixTree<T>::buildFromSorted(NodeArena &arena, const std::vector<std::tuple<int, int, T> > &entries) {
+  const std::tuple<int, int, T> *entry = entries.data();
+  auto next = [&](const Color color) {
+    const auto &[row, column, value] = *entry++;
+    return arena.create(value, row, column, color);
+  };
+
+  return linkBalanced(entries.size(), balancedBlackHeight(entries.size()), next);
+}
+
+/// @brief Transforma a árvore, sem alocar, numa lista em ordem simétrica ligada pelos filhos direitos,
+///        rotacionando filhos esquerdos para a direita até nenhum nó ter filho esquerdo
+/// @param root raiz da árvore
+/// @param size recebe o número de nós
+/// @return primeiro nó da lista
+template<typename T>
+typename BasicSparseMatrixTree<T>::TreeNode *
+BasicSparseMatrixTree<T>::flatten(TreeNode *root, size_t &size) {
+  TreeNode head;
+  TreeNode *tail = &head;
+  size = 0;
+  while (root) {
+    if (TreeNode *left = root->left) {
+      root->left = left->right;
+      left->right = root;
+      root = left;
+    } else {
+      tail->right = root;
+      tail = root;
+      size++;
+      root = root->right;
+    }
+  }
+  tail->right = nullptr;
+  return head.right;
+}
+
+/// @brief Tira de uma lista ligada pelos filhos direitos os nós com valor zero, devolvendo-os à arena
+/// @param list primeiro nó da lista
+/// @param size número de nós da lista, diminuído dos nós retirados
+/// @return primeiro nó da lista sem os zeros
+template<typename T>
+typename BasicSparseMatrixTree<T>::TreeNode *
+BasicSparseMatrixTree<T>::dropZeros(NodeArena &arena, TreeNode *list, size_t &size) {
+  TreeNode head;
+  TreeNode *tail = &head;
+  while (list) {
+    TreeNode *node = list;
+    list = list->right;
+    if (node->value != T{}) {
+      tail = tail->right = node;
+    } else {
+      arena.destroy(node);
+      size--;
+    }
+  }
+  tail->right = nullptr;
+  return head.right;
+}
+
+/// @brief Religa em O(k) os nós de uma lista ordenada numa árvore rubronegra balanceada, sem alocar
+/// @param list primeiro nó da lista ligada pelos filhos direitos
+/// @param size número de nós da lista
+/// @return raiz da árvore
+template<typename T>
+typename BasicSparseMatrixTree<T>::TreeNode *
+BasicSparseMatrixTree<T>::relink(TreeNode *list, const size_t size) {
+  auto next = [&](const Color color) {
+    TreeNode *node = list;
+    list = list->right;
+    node->color = color;
+    node->parent = nullptr;
+    return node;
+  };
+
+  return linkBalanced(size, balancedBlackHeight(size), next);
+}
+
+/// @brief Ordena os elementos, mantém o último valor de cada coordenada repetida e constrói a árvore em O(k)
+/// @param arena arena onde os nós são alocados
+/// @param entries elementos (linha, coluna, valor) em qualquer ordem
+/// @return raiz da árvore
+template<typename T>
+typename BasicSparseMatrixTree<T>::TreeNode *
+BasicSparseMatrixTree<T>::buildFromUnsorted(NodeArena &arena, std::vector<std::tuple<int, int, T> > entries) {
+  std::stable_sort(entries.begin(), entries.end(), [](const auto &x, const auto &y) {
+    return isLessThan(std::get<0>(x), std::get<1>(x), std::get<0>(y), std::get<1>(y));
+  });
+
+  size_t last = 0;
+  for (size_t p = 0; p < entries.size(); p++) {
+    if (last > 0 && std::get<0>(entries[last - 1]) == std::get<0>(entries[p]) &&
+        std::get<1>(entries[last - 1]) == std::get<1>(entries[p])) {
+      entries[last - 1] = entries[p];
+    } else {
+      entries[last++] = entries[p];
+    }
+  }
+  entries.resize(last);
+
+  return buildFromSorted(arena, entries);
+}
+
 /// @brief Função que procura se uma posição da matriz possui nó na árvore
 /// @param node nó investigado
 /// @param i valor de linha procurado
 /// @param j valor de coluna procurado
 /// @param transpose flag para identificar se a matriz que a árvore representa é a sua transposta
 /// @return nó procurado ou nulo
-SparseMatrixTree::TreeNode *SparseMatrixTree::findElement(TreeNode *node, int i, int j, bool transpose) {
-  while (node) {
-    int nodeRow = transpose ? node->column : node->row;
-    int nodeColumn = transpose ? node->row : node->column;
+template<typename T>
+typename BasicSparseMatrixTree<T>::TreeNode *
+BasicSparseMatrixTree<T>::findElement(TreeNode *node, int i, int j, bool transpose) {
+  // A árvore é ordenada pelas coordenadas guardadas, então a busca na transposta procura (j, i)
+  if (transpose) {
+    std::swap(i, j);
+  }
 
-    if (i == nodeRow && j == nodeColumn) {
+  while (node) {
+    if (i == node->row && j == node->column) {
       return node;
     }
 
-    if (i < nodeRow || (i == nodeRow && j < nodeColumn))
+    if (isLessThan(i, j, node->row, node->column))
       node = node->left;
     else {
       node = node->right;
@@ -164,11 +645,56 @@ SparseMatrixTree::TreeNode *SparseMatrixTree::findElement(TreeNode *node, int i,
   return nullptr;
 }
 
+/// @brief Procura count posições de uma vez, intercalando as descidas de grupos de FIND_GROUP buscas: a cada
+///        rodada cada descida do grupo avança um nível e pede o nó seguinte ao processador, então as faltas de
+///        cache de descidas independentes se sobrepõem em vez de se somarem
+/// @param positions coordenadas (linha, coluna) procuradas
+/// @param transpose flag para identificar se a matriz que a árvore representa é a sua transposta
+/// @param found recebe, para cada posição, o nó procurado ou nulo
+template<typename T>
+void BasicSparseMatrixTree<T>::findBatch(TreeNode *root, const std::pair<int, int> *positions, const size_t count,
+                                         const bool transpose, TreeNode **found) {
+  TreeNode *cursor[FIND_GROUP];
+
+  for (size_t begin = 0; begin < count; begin += FIND_GROUP) {
+    const size_t end = std::min(count, begin + FIND_GROUP);
+    for (size_t t = begin; t < end; t++) {
+      cursor[t - begin] = root;
+      found[t] = nullptr;
+    }
+
+    for (bool descending = root != nullptr; descending;) {
+      descending = false;
+      for (size_t t = begin; t < end; t++) {
+        TreeNode *&node = cursor[t - begin];
+        if (!node) {
+          continue;
+        }
+
+        const int i = transpose ? positions[t].second : positions[t].first;
+        const int j = transpose ? positions[t].first : positions[t].second;
+        if (i == node->row && j == node->column) {
+          found[t] = node;
+          node = nullptr;
+          continue;
+        }
+
+        node = isLessThan(i, j, node->row, node->column) ? node->left : node->right;
+        if (node) {
+          __builtin_prefetch(node);
+          descending = true;
+        }
+      }
+    }
+  }
+}
+
 /// @brief Função auxiliar da soma de matrizes que faz o percurso inorder da árvore e coloca em um vetor
 /// @param root
 /// @param transpose
 /// @param resultingTreeVec
-void SparseMatrixTree::inorderGet(TreeNode *root, bool transpose, std::vector<TreeNode *> &resultingTreeVec) {
+template<typename T>
+void BasicSparseMatrixTree<T>::inorderGet(TreeNode *root, bool transpose, std::vector<TreeNode *> &resultingTreeVec) {
   if (!root) {
     return;
   }
@@ -178,64 +704,302 @@ void SparseMatrixTree::inorderGet(TreeNode *root, bool transpose, std::vector<Tr
   inorderGet(root->right, transpose, resultingTreeVec);
 }
 
+/// @brief Função que coleta os elementos da árvore como (linha, coluna, valor) lógicos, ordenados por linha e coluna.
+///        Sem transposição o percurso inorder já está nessa ordem; com transposição é preciso reordenar
+/// @param root nó raiz
+/// @param transpose flag que identifica se a árvore representa a transposta
+/// @param entries vetor resultante
+template<typename T>
+void BasicSparseMatrixTree<T>::sortedEntries(TreeNode *root, bool transpose,
+                                             std::vector<std::tuple<int, int, T> > &entries) {
+  std::vector<TreeNode *> nodes;
+  inorderGet(root, transpose, nodes);
+
+  entries.reserve(entries.size() + nodes.size());
+  for (const TreeNode *node: nodes) {
+    if (!transpose) {
+      entries.emplace_back(node->row, node->column, node->value);
+    } else {
+      entries.emplace_back(node->column, node->row, node->value);
+    }
+  }
+
+  if (transpose) {
+    std::sort(entries.begin(), entries.end());
+  }
+}
+
+/// @brief Elementos não nulos da linha i da matriz lógica como (coluna, valor), ordenados por coluna.
+///        Sem transposição custa O(log k + saída); numa árvore transposta a linha é uma coluna guardada e
+///        custa O(k)
+/// @param root nó raiz
+/// @param transpose flag que identifica se a árvore representa a transposta
+/// @param i linha
+/// @param entries vetor ao qual os elementos são acrescentados
+template<typename T>
+void BasicSparseMatrixTree<T>::rowEntries(const TreeNode *root, const bool transpose, const int i,
+                                          std::vector<std::pair<int, T> > &entries) {
+  storedLine(root, !transpose, i, entries);
+}
+
+/// @brief Elementos não nulos da coluna j da matriz lógica como (linha, valor), ordenados por linha.
+///        Custa O(log k + saída) numa árvore transposta e O(k) sem transposição
+/// @param root nó raiz
+/// @param transpose flag que identifica se a árvore representa a transposta
+/// @param j coluna
+/// @param entries vetor ao qual os elementos são acrescentados
+template<typename T>
+void BasicSparseMatrixTree<T>::columnEntries(const TreeNode *root, const bool transpose, const int j,
+                                             std::vector<std::pair<int, T> > &entries) {
+  storedLine(root, transpose, j, entries);
+}
+
+/// @brief Bloco [r0, r1) x [c0, c1) da matriz lógica como uma nova árvore (sem transposição), com índices a
+///        partir de (r0, c0). A descida visita só as chaves entre (r0, c0) e (r1 - 1, c1 - 1) na ordem da
+///        árvore, ou seja, as linhas guardadas do bloco: um bloco de linhas inteiras custa O(log k + saída)
+/// @param arena arena onde os nós do bloco são alocados
+/// @param root nó raiz
+/// @param transpose flag que identifica se a árvore representa a transposta
+/// @return raiz da árvore do bloco
+template<typename T>
+typename BasicSparseMatrixTree<T>::TreeNode *
+BasicSparseMatrixTree<T>::submatrix(NodeArena &arena, const TreeNode *root, const bool transpose, const int r0,
+                                    const int r1, const int c0, const int c1) {
+  assert(r0 <= r1 && c0 <= c1);
+  if (r0 == r1 || c0 == c1) {
+    return nullptr;
+  }
+
+  // Intervalos nas dimensões guardadas: a principal ordena a árvore, a secundária só filtra
+  const int majorBegin = transpose ? c0 : r0, majorEnd = transpose ? c1 : r1;
+  const int minorBegin = transpose ? r0 : c0, minorEnd = transpose ? r1 : c1;
+
+  std::vector<std::tuple<int, int, T> > entries;
+  visitRange(root, {majorBegin, minorBegin}, {majorEnd - 1, minorEnd - 1}, [&](const TreeNode *node) {
+    if (minorBegin <= node->column && node->column < minorEnd) {
+      if (!transpose) {
+        entries.emplace_back(node->row - r0, node->column - c0, node->value);
+      } else {
+        entries.emplace_back(node->column - r0, node->row - c0, node->value);
+      }
+    }
+  });
+
+  if (transpose) {
+    std::sort(entries.begin(), entries.end());
+  }
+  return buildFromSorted(arena, entries);
+}
+
 /// @brief Função que realiza soma de duas matrizes representadas por árvores rubronegras
+/// @param arena arena onde os nós da matriz resultante são alocados
 /// @param root_a nó raiz da matriz A
 /// @param root_b nó raiz da matriz B
 /// @param transpose_a flag que identifica se matriz A é transposta
 /// @param transpose_b flag que identifica se matriz B é transposta
 /// @return árvore da matriz resultante
-SparseMatrixTree::TreeNode *SparseMatrixTree::sumMatrices(TreeNode *root_a, TreeNode *root_b, bool transpose_a,
-                                                          bool transpose_b) {
-  std::vector<TreeNode *> a, b;
-
-  inorderGet(root_a, transpose_a, a);
-  inorderGet(root_b, transpose_b, b);
-
-  TreeNode *result = nullptr;
-  int i = 0, j = 0;
-
-  while (i < (int) a.size() || j < (int) b.size()) {
-    int a_row = 0, a_col = 0, a_value = 0;
-    int b_row = 0, b_col = 0, b_value = 0;
+template<typename T>
+typename BasicSparseMatrixTree<T>::TreeNode *
+BasicSparseMatrixTree<T>::sumMatrices(NodeArena &arena, TreeNode *root_a, TreeNode *root_b, bool transpose_a,
+                                      bool transpose_b) {
+  std::vector<std::tuple<int, int, T> > a, b, c;
 
-    if (i < (int) a.size()) {
-      a_row = transpose_a ? a[i]->column : a[i]->row;
-      a_col = transpose_a ? a[i]->row : a[i]->column;
-      a_value = a[i]->value;
-    }
+  sortedEntries(root_a, transpose_a, a);
+  sortedEntries(root_b, transpose_b, b);
+  c.reserve(a.size() + b.size());
 
-    if (j < (int) b.size()) {
-      b_row = transpose_b ? b[j]->column : b[j]->row;
-      b_col = transpose_b ? b[j]->row : b[j]->column;
-      b_value = b[j]->value;
-    }
+  size_t i = 0, j = 0;
 
+  while (i < a.size() || j < b.size()) {
     // Caso 1: tem coordenada em A e em B
-    if (i < (int) a.size() && j < (int) b.size() && a_row == b_row && a_col == b_col) {
-      int sum = a_value + b_value;
-      if (sum != 0) {
-        result = insert(result, a_row, a_col, sum);
+    if (i < a.size() && j < b.size() && std::get<0>(a[i]) == std::get<0>(b[j]) &&
+        std::get<1>(a[i]) == std::get<1>(b[j])) {
+      const T sum = std::get<2>(a[i]) + std::get<2>(b[j]);
+      if (sum != T{}) {
+        c.emplace_back(std::get<0>(a[i]), std::get<1>(a[i]), sum);
       }
       i++;
       j++;
-    } else if (j >= (int) b.size() || (i < (int) a.size() && (
-                                         a_row < b_row || (a_row == b_row && (a_col < b_col))))) {
+    } else if (j >= b.size() || (i < a.size() && isLessThan(std::get<0>(a[i]), std::get<1>(a[i]),
+                                                            std::get<0>(b[j]), std::get<1>(b[j])))) {
       // Caso 2: só tem a coordenada em A
-      result = insert(result, a_row, a_col, a_value);
+      c.push_back(a[i]);
       i++;
     } else {
       // Caso 3: só tem na coordenada B:
-      result = insert(result, b_row, b_col, b_value);
+      c.push_back(b[j]);
       j++;
     }
   }
-  return result;
+
+  return buildFromSorted(arena, c);
+}
+
+/// @brief Soma em A, em ordem, os elementos de B já na orientação física de A. Quando B é pequena perto de A,
+///        cada elemento é buscado e atualizado ou inserido em O(log k), sem percorrer A inteira; caso contrário
+///        A é achatada numa lista, mesclada com B num único passo e religada balanceada
+template<typename T>
+class BasicSparseMatrixTree<T>::Merger {
+  NodeArena &arena;
+  TreeNode *root;
+  bool merging;
+  TreeNode head;
+  TreeNode *tail = &head;
+  TreeNode *pending = nullptr;
+  size_t size = 0;
+  size_t cancelled = 0;
+
+public:
+  Merger(NodeArena &arena, TreeNode *root, const size_t incoming) : arena(arena), root(root) {
+    // A árvore tem ao menos 2^h - 1 nós, com h a altura negra medida no caminho mais à esquerda. Percorrer A
+    // inteira só compensa quando B tem ao menos metade desse tamanho: as buscas individuais tocam poucos nós
+    // de A, enquanto a mescla passa por todos eles, espalhados pela arena
+    int blackHeight = 0;
+    for (const TreeNode *node = root; node; node = node->left) {
+      blackHeight += isBlack(node);
+    }
+    const double lowerBound = blackHeight < 63 ? static_cast<double>((1ULL << blackHeight) - 1) : 1e18;
+    merging = 2.0 * static_cast<double>(incoming) >= lowerBound;
+    if (merging) {
+      pending = flatten(root, size);
+    }
+  }
+
+  /// @brief Soma um elemento de B: atualiza o nó de A na mesma coordenada (liberando-o se zerar) ou encaixa
+  ///        um nó novo. spare, quando não nulo, é um nó de B que volta para a arena e é reaproveitado
+  void add(const int row, const int column, const T value, TreeNode *spare) {
+    if (spare) {
+      arena.destroy(spare);
+    }
+
+    if (!merging) {
+      if (TreeNode *node = findElement(root, row, column, false)) {
+        node->value += value;
+        cancelled += node->value == T{};
+      } else if (value != T{}) {
+        root = insert(arena, root, row, column, value);
+      }
+      return;
+    }
+
+    while (pending && isLessThan(pending->row, pending->column, row, column)) {
+      tail = tail->right = pending;
+      pending = pending->right;
+    }
+
+    if (pending && pending->row == row && pending->column == column) {
+      TreeNode *node = pending;
+      pending = pending->right;
+      node->value += value;
+      if (node->value != T{}) {
+        tail = tail->right = node;
+      } else {
+        arena.destroy(node);
+        size--;
+      }
+    } else if (value != T{}) {
+      tail = tail->right = arena.create(value, row, column, BLACK);
+      size++;
+    }
+  }
+
+  TreeNode *finish() {
+    if (!merging) {
+      if (cancelled == 0) {
+        return root;
+      }
+      // Retira de uma vez as coordenadas que se anularam
+      pending = dropZeros(arena, flatten(root, size), size);
+    }
+
+    tail->right = pending;
+    return relink(head.right, size);
+  }
+};
+
+/// @brief Soma B em A reaproveitando os nós de A: coordenadas comuns são atualizadas, novas são encaixadas
+///        e as que se anulam voltam para a arena, sem vetores auxiliares quando A e B têm a mesma orientação
+/// @param arena arena dona dos nós de A, onde os novos nós são alocados
+/// @param root_a nó raiz da matriz A, que deixa de ser válida (use a raiz devolvida)
+/// @param root_b nó raiz da matriz B, que não é alterada
+/// @param transpose_a flag que identifica se matriz A é transposta; o resultado mantém a mesma orientação
+/// @param transpose_b flag que identifica se matriz B é transposta
+/// @return nova raiz de A
+template<typename T>
+typename BasicSparseMatrixTree<T>::TreeNode *
+BasicSparseMatrixTree<T>::addInPlace(NodeArena &arena, TreeNode *root_a, const TreeNode *root_b, const bool transpose_a,
+                                     const bool transpose_b) {
+  size_t incoming = 0;
+  visitInorder(root_b, [&](const TreeNode *) {
+    incoming++;
+  });
+
+  Merger merger(arena, root_a, incoming);
+  if (transpose_a == transpose_b) {
+    visitInorder(root_b, [&](const TreeNode *node) {
+      merger.add(node->row, node->column, node->value, nullptr);
+    });
+  } else {
+    std::vector<std::tuple<int, int, T> > entries;
+    visitInorder(root_b, [&](const TreeNode *node) {
+      entries.emplace_back(node->column, node->row, node->value);
+    });
+    std::sort(entries.begin(), entries.end());
+    for (const auto &[row, column, value]: entries) {
+      merger.add(row, column, value, nullptr);
+    }
+  }
+
+  return merger.finish();
+}
+
+/// @brief Soma B em A consumindo B: cada nó de B volta para a arena logo antes de a coordenada dele ser somada,
+///        e é o nó reaproveitado quando ela é nova em A, então a soma não aumenta a arena
+/// @param arena arena dona dos nós de A e de B
+/// @param root_a nó raiz da matriz A, que deixa de ser válida (use a raiz devolvida)
+/// @param root_b nó raiz da matriz B, que deixa de existir
+/// @param transpose_a flag que identifica se matriz A é transposta; o resultado mantém a mesma orientação
+/// @param transpose_b flag que identifica se matriz B é transposta
+/// @return nova raiz de A
+template<typename T>
+typename BasicSparseMatrixTree<T>::TreeNode *
+BasicSparseMatrixTree<T>::addInPlaceConsuming(NodeArena &arena, TreeNode *root_a, TreeNode *root_b,
+                                              const bool transpose_a, const bool transpose_b) {
+  size_t size;
+  TreeNode *list = flatten(root_b, size);
+
+  // Com orientações diferentes, os nós de B passam para a orientação física de A e são reordenados
+  if (transpose_a != transpose_b) {
+    std::vector<TreeNode *> nodes;
+    nodes.reserve(size);
+    for (TreeNode *node = list; node; node = node->right) {
+      std::swap(node->row, node->column);
+      nodes.push_back(node);
+    }
+    std::sort(nodes.begin(), nodes.end(), [](const TreeNode *x, const TreeNode *y) {
+      return isLessThan(x->row, x->column, y->row, y->column);
+    });
+    for (size_t p = 0; p < nodes.size(); p++) {
+      nodes[p]->right = p + 1 < nodes.size() ? nodes[p + 1] : nullptr;
+    }
+    list = nodes.empty() ? nullptr : nodes.front();
+  }
+
+  Merger merger(arena, root_a, size);
+  while (list) {
+    TreeNode *node = list;
+    list = list->right;
+    merger.add(node->row, node->column, node->value, node);
+  }
+
+  return merger.finish();
 }
 
 /// @brief Função que multiplica os valores de uma matriz na árvore por um escalar
 /// @param root nó raíz da árvore em questão
 /// @param multiplier escalar que fará a multiplicação
-void SparseMatrixTree::multScalarMatrix(TreeNode *root, int multiplier) {
+template<typename T>
+void BasicSparseMatrixTree<T>::multScalarMatrix(TreeNode *root, T multiplier) {
   if (!root) {
     return;
   }
@@ -244,59 +1008,301 @@ void SparseMatrixTree::multScalarMatrix(TreeNode *root, int multiplier) {
   multScalarMatrix(root->right, multiplier);
 }
 
-/// @brief Função auxiliar da multiplicação de matrizes que realiza a soma parcial dos valores de uma operação de linha x coluna
-/// @param node nó em questão
-/// @param i linha
-/// @param j coluna
-/// @param val valor a ser somado
-/// @return nó com a soma atualizada
-SparseMatrixTree::TreeNode *SparseMatrixTree::auxMultMatrices(TreeNode *node, int i, int j, int val) {
-  if (TreeNode *n = findElement(node, i, j, false)) {
-    n->value += val;
-    return node;
+/// @brief Multiplicação por escalar que não deixa zeros: por zero, todos os nós voltam para a arena
+/// @param arena arena dona dos nós da árvore
+/// @return nova raiz (nula se multiplier for zero)
+template<typename T>
+typename BasicSparseMatrixTree<T>::TreeNode *
+BasicSparseMatrixTree<T>::multScalarMatrix(NodeArena &arena, TreeNode *root, T multiplier) {
+  if (multiplier == T{}) {
+    arena.destroyTree(root);
+    return nullptr;
   }
-
-  return insert(node, i, j, val);
+  multScalarMatrix(root, multiplier);
+  return root;
 }
 
-/// @brief Função que realiza multiplicação de matrizes
+/// @brief Função que realiza multiplicação de matrizes por junção indexada por linha:
+///        B é agrupada por linha, então cada elemento A(i, k) só visita a linha k de B.
+///        Cada linha i de C é acumulada em um acumulador esparso e inserida já ordenada
+/// @param arena arena onde os nós da matriz resultante são alocados
 /// @param root_a nó raíz da matriz A
 /// @param root_b nó raiz da matriz B
 /// @param transpose_a flag para transposição
 /// @param transpose_b flag para transposição
 /// @return árvore resultante do resultado da operações
-SparseMatrixTree::TreeNode *SparseMatrixTree::multMatrices(TreeNode *root_a, TreeNode *root_b, bool transpose_a,
-                                                           bool transpose_b) {
-  std::vector<TreeNode *> a, b;
-  inorderGet(root_a, transpose_a, a);
-  inorderGet(root_b, transpose_b, b);
-  TreeNode *result = nullptr;
-
-  for (TreeNode *ai: a) {
-    int ai_row = transpose_a ? ai->column : ai->row;
-    int ai_column = transpose_a ? ai->row : ai->column;
-    int ai_value = ai->value;
-    for (TreeNode *bj: b) {
-      int bj_row = transpose_a ? bj->column : bj->row;
-      int bj_col = transpose_a ? bj->row : bj->column;
-      int bj_value = bj->value;
-
-      if (ai_column == bj_row) {
-        int val = ai_value * bj_value;
-        if (val != 0) {
-          result = auxMultMatrices(result, ai_row, bj_col, val);
+template<typename T>
+typename BasicSparseMatrixTree<T>::TreeNode *
+BasicSparseMatrixTree<T>::multMatrices(NodeArena &arena, TreeNode *root_a, TreeNode *root_b, bool transpose_a,
+                                       bool transpose_b) {
+  std::vector<std::tuple<int, int, T> > a, b;
+  sortedEntries(root_a, transpose_a, a);
+  sortedEntries(root_b, transpose_b, b);
+
+  if (a.empty() || b.empty()) {
+    return nullptr;
+  }
+
+  // Índice de linhas de B: as entradas da linha k ficam em b[rowStart[k], rowStart[k + 1])
+  const int b_rows = std::get<0>(b.back()) + 1;
+  int b_columns = 0;
+  std::vector<int> rowStart(b_rows + 1, 0);
+  for (const auto &[row, column, value]: b) {
+    rowStart[row + 1]++;
+    b_columns = std::max(b_columns, column + 1);
+  }
+  for (int k = 0; k < b_rows; k++) {
+    rowStart[k + 1] += rowStart[k];
+  }
+
+  SparseAccumulator<T> accumulator(b_columns);
+  std::vector<std::tuple<int, int, T> > c;
+
+  for (size_t p = 0; p < a.size();) {
+    const int ai_row = std::get<0>(a[p]);
+
+    for (; p < a.size() && std::get<0>(a[p]) == ai_row; p++) {
+      const auto [row, ai_column, ai_value] = a[p];
+      if (ai_column >= b_rows) {
+        continue;
+      }
+
+      for (int q = rowStart[ai_column]; q < rowStart[ai_column + 1]; q++) {
+        const auto [bj_row, bj_col, bj_value] = b[q];
+        accumulator.add(bj_col, ai_value * bj_value);
+      }
+    }
+
+    accumulator.flush(true, [&](const int column, const T value) {
+      if (value != T{}) {
+        c.emplace_back(ai_row, column, value);
+      }
+    });
+  }
+
+  return buildFromSorted(arena, c);
+}
+
+/// @brief Função auxiliar que calcula as dimensões mínimas da matriz representada (maior linha e coluna + 1)
+/// @param root nó raiz
+/// @param transpose flag de transposição
+/// @return par (linhas, colunas) lógicas
+template<typename T>
+std::pair<int, int> BasicSparseMatrixTree<T>::dimensions(const TreeNode *root, bool transpose) {
+  if (!root) {
+    return {0, 0};
+  }
+
+  const auto [left_rows, left_columns] = dimensions(root->left, transpose);
+  const auto [right_rows, right_columns] = dimensions(root->right, transpose);
+  const int rows = std::max({left_rows, right_rows, (transpose ? root->column : root->row) + 1});
+  const int columns = std::max({left_columns, right_columns, (transpose ? root->row : root->column) + 1});
+  return {rows, columns};
+}
+
+/// @brief Multiplicação de matrizes em paralelo: as árvores são comprimidas (CSR/CSC) em uma passada inorder,
+///        o produto é feito pela multiplicação de Gustavson dividida por linhas entre as threads,
+///        e o resultado, já ordenado, vira a árvore final por construção em massa
+/// @param arena arena onde os nós da matriz resultante são alocados
+/// @param root_a nó raíz da matriz A
+/// @param root_b nó raiz da matriz B
+/// @param transpose_a flag para transposição
+/// @param transpose_b flag para transposição
+/// @param pool conjunto de threads
+/// @return árvore resultante
+template<typename T>
+typename BasicSparseMatrixTree<T>::TreeNode *
+BasicSparseMatrixTree<T>::multMatricesParallel(NodeArena &arena, TreeNode *root_a, TreeNode *root_b, bool transpose_a,
+                                               bool transpose_b, ThreadPool &pool) {
+  const auto [a_rows, a_columns] = dimensions(root_a, transpose_a);
+  const auto [b_rows, b_columns] = dimensions(root_b, transpose_b);
+  const int inner = std::max(a_columns, b_rows);
+
+  using CSR = BasicSparseMatrixCSR<T>;
+  const CSR a = CSR::fromTree(root_a, a_rows, inner, transpose_a);
+  const CSR b = CSR::fromTree(root_b, inner, b_columns, transpose_b);
+  const CSR product = a.multParallel(b, pool);
+
+  std::vector<std::tuple<int, int, T> > c;
+  c.reserve(product.nnz());
+  for (int i = 0; i < product.rows(); i++) {
+    const typename CSR::Slice row = product.row(i);
+    for (int p = 0; p < row.size; p++) {
+      if (row.value[p] != T{}) {
+        c.emplace_back(i, row.index[p], row.value[p]);
+      }
+    }
+  }
+
+  return buildFromSorted(arena, c);
+}
+
+/// @brief Função auxiliar que soma a contribuição de uma subárvore em y += A * x, com x e y densos de largura
+///        width em ordem por linhas
+/// @param root raiz da subárvore
+/// @param transpose flag de transposição
+/// @param x entrada densa
+/// @param y saída densa
+/// @param width número de colunas de x e y
+template<typename T>
+void BasicSparseMatrixTree<T>::accumulateProduct(const TreeNode *root, bool transpose, const T *x, T *y, int width) {
+  while (root) {
+    accumulateProduct(root->left, transpose, x, y, width);
+
+    const int row = transpose ? root->column : root->row;
+    const int column = transpose ? root->row : root->column;
+    const T *__restrict source = x + static_cast<size_t>(column) * width;
+    T *__restrict target = y + static_cast<size_t>(row) * width;
+    for (int c = 0; c < width; c++) {
+      target[c] += root->value * source[c];
+    }
+
+    root = root->right;
+  }
+}
+
+/// @brief Como accumulateProduct sem transposição, para uma subárvore cujas linhas ficam em [first, last]. As
+///        linhas entre first e last só aparecem nela e são somadas direto em y; first e last podem aparecer
+///        também nas vizinhas e vão para edges (width valores para first, seguidos de width para last)
+template<typename T>
+void BasicSparseMatrixTree<T>::accumulateRows(const TreeNode *root, const T *x, T *y, int width, int first,
+                                              int last, T *edges) {
+  while (root) {
+    accumulateRows(root->left, x, y, width, first, last, edges);
+
+    const T *__restrict source = x + static_cast<size_t>(root->column) * width;
+    T *__restrict target = root->row == first ? edges
+                           : root->row == last ? edges + width
+                           : y + static_cast<size_t>(root->row) * width;
+    for (int c = 0; c < width; c++) {
+      target[c] += root->value * source[c];
+    }
+
+    root = root->right;
+  }
+}
+
+/// @brief Função auxiliar do produto por vetor/bloco denso. Em paralelo, as subárvores de uma profundidade
+///        fixa viram tarefas; os poucos nós acima delas são processados pela thread que chama. Sem
+///        transposição, cada subárvore cobre um intervalo contíguo de linhas e escreve direto em y, exceto
+///        nas linhas das pontas; com ela, as tarefas acumulam em saídas locais que depois são somadas
+/// @param outputs tamanho de y
+/// @param pool conjunto de threads, ou nulo para executar em série
+template<typename T>
+void BasicSparseMatrixTree<T>::product(const TreeNode *root, bool transpose, const T *x, T *y, size_t outputs,
+                                       int width, ThreadPool *pool) {
+  std::fill(y, y + outputs, T{});
+  if (pool == nullptr || pool->size() == 1) {
+    accumulateProduct(root, transpose, x, y, width);
+    return;
+  }
+
+  std::vector<const TreeNode *> level = {root}, above;
+  while (level.size() < static_cast<size_t>(pool->size()) * 2) {
+    std::vector<const TreeNode *> next;
+    for (const TreeNode *node: level) {
+      if (node) {
+        above.push_back(node);
+        next.push_back(node->left);
+        next.push_back(node->right);
+      }
+    }
+    if (next.empty()) {
+      break;
+    }
+    level.swap(next);
+  }
+
+  if (transpose) {
+    parallelAccumulate(*pool, static_cast<int>(level.size()), outputs, y, [&](const int t, T *local) {
+      accumulateProduct(level[t], transpose, x, local, width);
+    });
+  } else {
+    std::vector<int> first(level.size()), last(level.size());
+    std::vector<T> edges(level.size() * 2 * width, T{});
+    pool->run(static_cast<int>(level.size()), [&](const int t) {
+      if (level[t] == nullptr) {
+        return;
+      }
+      const TreeNode *node = level[t];
+      while (node->left) {
+        node = node->left;
+      }
+      first[t] = node->row;
+      node = level[t];
+      while (node->right) {
+        node = node->right;
+      }
+      last[t] = node->row;
+      accumulateRows(level[t], x, y, width, first[t], last[t], edges.data() + t * 2 * width);
+    });
+
+    for (size_t t = 0; t < level.size(); t++) {
+      if (level[t] == nullptr) {
+        continue;
+      }
+      const T *edge = edges.data() + t * 2 * width;
+      for (int c = 0; c < width; c++) {
+        y[static_cast<size_t>(first[t]) * width + c] += edge[c];
+        if (last[t] != first[t]) {
+          y[static_cast<size_t>(last[t]) * width + c] += edge[width + c];
         }
       }
     }
   }
 
-  return result;
+  for (const TreeNode *node: above) {
+    const int row = transpose ? node->column : node->row;
+    const int column = transpose ? node->row : node->column;
+    for (int c = 0; c < width; c++) {
+      y[static_cast<size_t>(row) * width + c] += node->value * x[static_cast<size_t>(column) * width + c];
+    }
+  }
+}
+
+/// @brief Produto matriz-vetor y = A * x percorrendo a árvore em ordem
+/// @param root nó raiz da matriz A
+/// @param transpose flag de transposição (com ela, calcula A^T * x)
+/// @param x vetor de entrada
+/// @param y vetor de saída, já dimensionado com o número de linhas do resultado
+template<typename T>
+void BasicSparseMatrixTree<T>::multVector(const TreeNode *root, bool transpose, const std::vector<T> &x,
+                                          std::vector<T> &y) {
+  product(root, transpose, x.data(), y.data(), y.size(), 1, nullptr);
+}
+
+template<typename T>
+void BasicSparseMatrixTree<T>::multVectorParallel(const TreeNode *root, bool transpose, const std::vector<T> &x,
+                                                  std::vector<T> &y, ThreadPool &pool) {
+  product(root, transpose, x.data(), y.data(), y.size(), 1, &pool);
+}
+
+/// @brief Produto por um bloco denso estreito Y = A * X
+/// @param root nó raiz da matriz A
+/// @param transpose flag de transposição
+/// @param X bloco denso de entrada
+/// @param Y bloco denso de saída, já dimensionado (linhas do resultado x colunas de X)
+template<typename T>
+void BasicSparseMatrixTree<T>::multDense(const TreeNode *root, bool transpose, const BasicDenseMatrix<T> &X,
+                                         BasicDenseMatrix<T> &Y) {
+  product(root, transpose, X.rowData(0), Y.rowData(0), static_cast<size_t>(Y.rows()) * Y.cols(), X.cols(),
+          nullptr);
+  Y *= X.scaleFactor();
+}
+
+template<typename T>
+void BasicSparseMatrixTree<T>::multDenseParallel(const TreeNode *root, bool transpose, const BasicDenseMatrix<T> &X,
+                                                 BasicDenseMatrix<T> &Y, ThreadPool &pool) {
+  product(root, transpose, X.rowData(0), Y.rowData(0), static_cast<size_t>(Y.rows()) * Y.cols(), X.cols(),
+          &pool);
+  Y *= X.scaleFactor();
 }
 
 /// @brief Função auxiliar para imprimir os valores da matriz de forma inorder
 /// @param root nó raíz
 /// @param transpose flag de tranposição da matriz em questão
-void SparseMatrixTree::printTree(const TreeNode *root, bool transpose) {
+template<typename T>
+void BasicSparseMatrixTree<T>::printTree(const TreeNode *root, bool transpose) {
   if (!root) {
     return;
   }
@@ -306,3 +1312,43 @@ void SparseMatrixTree::printTree(const TreeNode *root, bool transpose) {
   std::cout << "(" << nodeRow << ", " << nodeColumn << ") = " << root->value << std::endl;
   printTree(root->right, transpose);
 }
+
+/// @brief Confere as invariantes da árvore rubronegra inclinada à esquerda: raiz negra, nenhum filho direito
+///        vermelho, nenhum vermelho com filho esquerdo vermelho, a mesma altura negra em todos os caminhos e
+///        as chaves em ordem (linha, coluna) estritamente crescente
+/// @param root nó raiz
+/// @return verdadeiro se todas valem
+template<typename T>
+bool BasicSparseMatrixTree<T>::checkInvariants(const TreeNode *root) {
+  const TreeNode *previous = nullptr;
+  return !isRed(root) && checkedBlackHeight(root, previous) >= 0;
+}
+
+/// @brief Função auxiliar de checkInvariants que percorre a subárvore em ordem simétrica
+/// @param previous último nó visitado antes da subárvore, atualizado com o último dela
+/// @return altura negra da subárvore, ou -1 se alguma invariante falha
+template<typename T>
+int BasicSparseMatrixTree<T>::checkedBlackHeight(const TreeNode *node, const TreeNode *&previous) {
+  if (!node) {
+    return 0;
+  }
+  if (isRed(node->right) || (isRed(node) && isRed(node->left))) {
+    return -1;
+  }
+
+  const int left = checkedBlackHeight(node->left, previous);
+  if (left < 0 || (previous && !isLessThan(previous->row, previous->column, node->row, node->column))) {
+    return -1;
+  }
+  previous = node;
+  const int right = checkedBlackHeight(node->right, previous);
+  if (right != left) {
+    return -1;
+  }
+  return left + isBlack(node);
+}
+
+template class BasicSparseMatrixTree<float>;
+template class BasicSparseMatrixTree<double>;
+template class BasicSparseMatrixTree<std::int32_t>;
+template class BasicSparseMatrixTree<std::int64_t>;
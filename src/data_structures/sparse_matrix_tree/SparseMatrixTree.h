@@ -1,46 +1,142 @@
 #ifndef MC458_PROJETO_SPARSEMATRIXTREE_H
 #define MC458_PROJETO_SPARSEMATRIXTREE_H
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <utility>
 #include <vector>
 
-class SparseMatrixTree {
+#include "../dense_matrix/DenseMatrix.h"
+#include "../../parallel/ThreadPool.h"
+
+// Matriz esparsa em árvore rubronegra inclinada à esquerda com elementos do tipo T, instanciada em
+// SparseMatrixTree.cpp para float, double, int32_t e int64_t; SparseMatrixTree é a forma com double
+template<typename T>
+class BasicSparseMatrixTree {
   enum Color { RED, BLACK };
 
 public:
+  using Value = T;
+
   struct TreeNode {
-    int value;
+    T value;
     int row, column;
     Color color;
     TreeNode *left, *right, *parent;
 
-    TreeNode(int v = 0, int rw = 0, int col = 0, Color clr = BLACK,
+    TreeNode(T v = T{}, int rw = 0, int col = 0, Color clr = BLACK,
              TreeNode *l = nullptr, TreeNode *r = nullptr, TreeNode *p = nullptr);
+  };
+
+  // Arena dona dos nós de uma ou mais árvores: aloca em blocos contíguos, reaproveita nós
+  // liberados por uma lista livre e devolve toda a memória de uma vez na destruição
+  class NodeArena {
+    static constexpr size_t SLAB_NODES = 4096;
+
+    std::vector<TreeNode *> slabs;
+    size_t used = SLAB_NODES;
+    TreeNode *freeList = nullptr;
+    size_t live = 0;
+
+  public:
+    NodeArena() = default;
+
+    NodeArena(const NodeArena &) = delete;
+
+    NodeArena &operator=(const NodeArena &) = delete;
+
+    ~NodeArena();
+
+    TreeNode *create(T v, int rw, int col, Color clr);
+
+    void destroy(TreeNode *node);
+
+    void destroyTree(TreeNode *root);
+
+    void clear();
 
-    ~TreeNode();
+    size_t size() const;
   };
 
   // Main operations
-  static TreeNode *insert(TreeNode *root, int i, int j, int valueToInsert);
+  static TreeNode *insert(NodeArena &arena, TreeNode *root, int i, int j, T valueToInsert);
+
+  static TreeNode *erase(NodeArena &arena, TreeNode *root, int i, int j);
+
+  static TreeNode *set(NodeArena &arena, TreeNode *root, int i, int j, T value);
+
+  static TreeNode *pruneZeros(NodeArena &arena, TreeNode *root);
+
+  static TreeNode *buildFromSorted(NodeArena &arena, const std::vector<std::tuple<int, int, T> > &entries);
+
+  static TreeNode *buildFromUnsorted(NodeArena &arena, std::vector<std::tuple<int, int, T> > entries);
 
   static TreeNode *findElement(TreeNode *node, int i, int j, bool transpose);
 
+  static void findBatch(TreeNode *root, const std::pair<int, int> *positions, size_t count, bool transpose,
+                        TreeNode **found);
+
   static void inorderGet(TreeNode *root, bool transpose, std::vector<TreeNode *> &resultingTreeVec);
 
+  static void sortedEntries(TreeNode *root, bool transpose, std::vector<std::tuple<int, int, T> > &entries);
+
+  // Extraction
+  static void rowEntries(const TreeNode *root, bool transpose, int i, std::vector<std::pair<int, T> > &entries);
+
+  static void columnEntries(const TreeNode *root, bool transpose, int j, std::vector<std::pair<int, T> > &entries);
+
+  static TreeNode *submatrix(NodeArena &arena, const TreeNode *root, bool transpose, int r0, int r1, int c0, int c1);
+
   // Matrix operations
-  static TreeNode *sumMatrices(TreeNode *root_a, TreeNode *root_b, bool transpose_a, bool transpose_b);
+  static TreeNode *sumMatrices(NodeArena &arena, TreeNode *root_a, TreeNode *root_b, bool transpose_a, bool transpose_b);
+
+  static TreeNode *addInPlace(NodeArena &arena, TreeNode *root_a, const TreeNode *root_b, bool transpose_a,
+                              bool transpose_b);
+
+  static TreeNode *addInPlaceConsuming(NodeArena &arena, TreeNode *root_a, TreeNode *root_b, bool transpose_a,
+                                       bool transpose_b);
 
-  static void multScalarMatrix(TreeNode *root, int multiplier);
+  static void multScalarMatrix(TreeNode *root, T multiplier);
 
-  static TreeNode *multMatrices(TreeNode *root_a, TreeNode *root_b, bool transpose_a, bool transpose_b);
+  static TreeNode *multScalarMatrix(NodeArena &arena, TreeNode *root, T multiplier);
+
+  static TreeNode *multMatrices(NodeArena &arena, TreeNode *root_a, TreeNode *root_b, bool transpose_a, bool transpose_b);
+
+  static TreeNode *multMatricesParallel(NodeArena &arena, TreeNode *root_a, TreeNode *root_b, bool transpose_a,
+                                        bool transpose_b, ThreadPool &pool = ThreadPool::shared());
+
+  static void multVector(const TreeNode *root, bool transpose, const std::vector<T> &x, std::vector<T> &y);
+
+  static void multVectorParallel(const TreeNode *root, bool transpose, const std::vector<T> &x,
+                                 std::vector<T> &y, ThreadPool &pool = ThreadPool::shared());
+
+  static void multDense(const TreeNode *root, bool transpose, const BasicDenseMatrix<T> &X, BasicDenseMatrix<T> &Y);
+
+  static void multDenseParallel(const TreeNode *root, bool transpose, const BasicDenseMatrix<T> &X,
+                                BasicDenseMatrix<T> &Y, ThreadPool &pool = ThreadPool::shared());
 
   // Utility
   static void printTree(const TreeNode *root, bool transpose);
 
+  static bool checkInvariants(const TreeNode *root);
+
 private:
   // Helper functions
   static bool isLessThan(int i1, int j1, int i2, int j2);
 
+  static std::pair<int, int> dimensions(const TreeNode *root, bool transpose);
+
+  static void accumulateProduct(const TreeNode *root, bool transpose, const T *x, T *y, int width);
+
+  static void accumulateRows(const TreeNode *root, const T *x, T *y, int width, int first, int last, T *edges);
+
+  static void product(const TreeNode *root, bool transpose, const T *x, T *y, size_t outputs, int width,
+                      ThreadPool *pool);
+
   static bool isRed(const TreeNode *node);
 
+  static int checkedBlackHeight(const TreeNode *node, const TreeNode *&previous);
+
   static bool isBlack(const TreeNode *node);
 
   static TreeNode *rotateLeft(TreeNode *root);
@@ -49,8 +145,37 @@ private:
 
   static void riseRed(TreeNode *root);
 
-  static TreeNode *insertRBTree(TreeNode *root, int i, int j, int valueToInsert);
+  static void flipColors(TreeNode *root);
+
+  static TreeNode *moveRedLeft(TreeNode *root);
 
-  static TreeNode *auxMultMatrices(TreeNode *node, int i, int j, int val);
+  static TreeNode *moveRedRight(TreeNode *root);
+
+  static TreeNode *balance(TreeNode *root);
+
+  static TreeNode *eraseMin(NodeArena &arena, TreeNode *root);
+
+  static TreeNode *eraseRBTree(NodeArena &arena, TreeNode *root, int i, int j);
+
+  template<typename NextNode>
+  static TreeNode *linkBalanced(size_t size, int blackHeight, NextNode &next);
+
+  static TreeNode *flatten(TreeNode *root, size_t &size);
+
+  static TreeNode *dropZeros(NodeArena &arena, TreeNode *list, size_t &size);
+
+  static TreeNode *relink(TreeNode *list, size_t size);
+
+  class Merger;
+
+  static TreeNode *insertRBTree(NodeArena &arena, TreeNode *root, int i, int j, T valueToInsert);
 };
+
+extern template class BasicSparseMatrixTree<float>;
+extern template class BasicSparseMatrixTree<double>;
+extern template class BasicSparseMatrixTree<std::int32_t>;
+extern template class BasicSparseMatrixTree<std::int64_t>;
+
+using SparseMatrixTree = BasicSparseMatrixTree<double>;
+
 #endif //MC458_PROJETO_SPARSEMATRIXTREE_H
@@ -0,0 +1,78 @@
+#include "MappedFile.h"
+
+#include <fstream>
+#include <new>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define MC458_HAS_MMAP 1
+#endif
+
+namespace {
+  constexpr std::align_val_t BUFFER_ALIGNMENT{64};
+}
+
+/// @brief Abre o arquivo para leitura, mapeando-o em memória quando possível
+/// @throws std::runtime_error se o arquivo não pode ser aberto ou lido
+std::shared_ptr<const MappedFile> MappedFile::open(const std::string &path) {
+  std::shared_ptr<MappedFile> file(new MappedFile());
+
+#ifdef MC458_HAS_MMAP
+  if (const int fd = ::open(path.c_str(), O_RDONLY); fd >= 0) {
+    struct stat info{};
+    if (fstat(fd, &info) == 0 && info.st_size > 0) {
+      void *address = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+      if (address != MAP_FAILED) {
+        file->bytes = static_cast<const unsigned char *>(address);
+        file->length = static_cast<size_t>(info.st_size);
+        file->mapped = true;
+      }
+    }
+    ::close(fd);
+    if (file->mapped) {
+      return file;
+    }
+  }
+#endif
+
+  std::ifstream input(path, std::ios::binary | std::ios::ate);
+  if (!input) {
+    throw std::runtime_error("nao foi possivel abrir " + path);
+  }
+  file->length = static_cast<size_t>(input.tellg());
+  auto *buffer = static_cast<unsigned char *>(::operator new(file->length > 0 ? file->length : 1, BUFFER_ALIGNMENT));
+  file->bytes = buffer;
+  input.seekg(0);
+  if (!input.read(reinterpret_cast<char *>(buffer), static_cast<std::streamsize>(file->length))) {
+    throw std::runtime_error("erro ao ler " + path);
+  }
+  return file;
+}
+
+MappedFile::~MappedFile() {
+#ifdef MC458_HAS_MMAP
+  if (mapped) {
+    munmap(const_cast<unsigned char *>(bytes), length);
+    return;
+  }
+#endif
+  if (bytes != nullptr) {
+    ::operator delete(const_cast<unsigned char *>(bytes), BUFFER_ALIGNMENT);
+  }
+}
+
+const unsigned char *MappedFile::data() const {
+  return bytes;
+}
+
+size_t MappedFile::size() const {
+  return length;
+}
+
+bool MappedFile::isMapped() const {
+  return mapped;
+}
@@ -0,0 +1,34 @@
+#ifndef MC458_PROJETO_MAPPEDFILE_H
+#define MC458_PROJETO_MAPPEDFILE_H
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+// Conteúdo de um arquivo somente leitura, mapeado em memória (mmap) quando a plataforma permite;
+// caso contrário o arquivo é lido inteiro para um buffer alinhado. Os dados ficam válidos enquanto
+// existir algum shared_ptr para o objeto
+class MappedFile {
+  const unsigned char *bytes = nullptr;
+  size_t length = 0;
+  bool mapped = false;
+
+  MappedFile() = default;
+
+public:
+  static std::shared_ptr<const MappedFile> open(const std::string &path);
+
+  MappedFile(const MappedFile &) = delete;
+
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  ~MappedFile();
+
+  const unsigned char *data() const;
+
+  size_t size() const;
+
+  bool isMapped() const;
+};
+
+#endif //MC458_PROJETO_MAPPEDFILE_H
@@ -0,0 +1,315 @@
+#include "MatrixFile.h"
+#include "MappedFile.h"
+
+#include <climits>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+
+static_assert(sizeof(MatrixFile::Header) == 64, "o cabeçalho ocupa exatamente 64 bytes");
+
+namespace {
+  constexpr char MAGIC[8] = {'M', 'C', '4', '5', '8', 'M', 'T', 'X'};
+
+  // Soma de verificação por palavras de 64 bits (bytes finais completados com zeros), rápida o bastante
+  // para detectar arquivos truncados ou corrompidos sem limitar a velocidade de leitura
+  class Checksum {
+    std::uint64_t hash = 0x84222325cbf29ce4ULL;
+    std::uint64_t pending = 0;
+    int pendingBytes = 0;
+
+    void mixWord(const std::uint64_t word) {
+      hash ^= word * 0x9E3779B97F4A7C15ULL;
+      hash = ((hash << 27) | (hash >> 37)) * 0xC2B2AE3D27D4EB4FULL;
+    }
+
+  public:
+    void update(const void *data, size_t size) {
+      const auto *bytes = static_cast<const unsigned char *>(data);
+      while (size > 0 && pendingBytes > 0) {
+        pending |= static_cast<std::uint64_t>(*bytes++) << (8 * pendingBytes);
+        size--;
+        if (++pendingBytes == 8) {
+          mixWord(pending);
+          pending = 0;
+          pendingBytes = 0;
+        }
+      }
+      for (; size >= 8; size -= 8, bytes += 8) {
+        std::uint64_t word;
+        std::memcpy(&word, bytes, 8);
+        mixWord(word);
+      }
+      for (; size > 0; size--) {
+        pending |= static_cast<std::uint64_t>(*bytes++) << (8 * pendingBytes++);
+      }
+    }
+
+    std::uint64_t value() {
+      if (pendingBytes > 0) {
+        mixWord(pending);
+        pending = 0;
+        pendingBytes = 0;
+      }
+      return hash ^ (hash >> 29);
+    }
+  };
+
+  [[noreturn]] void fail(const std::string &path, const std::string &reason) {
+    throw std::runtime_error(path + ": " + reason);
+  }
+}
+
+size_t MatrixFile::align(const size_t offset) {
+  return (offset + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+}
+
+MatrixFile::Header MatrixFile::makeHeader(const Kind kind, const int rows, const int cols, const std::uint64_t nnz) {
+  Header header{};
+  std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+  header.version = VERSION;
+  header.kind = kind;
+  header.rows = rows;
+  header.cols = cols;
+  header.nnz = nnz;
+  header.indexBytes = sizeof(int);
+  header.valueBytes = sizeof(double);
+  return header;
+}
+
+/// @brief Grava o cabeçalho e os vetores, cada um completado com zeros até o próximo múltiplo de 64 bytes.
+///        O cabeçalho é regravado no fim com a soma de verificação do conteúdo
+/// @throws std::runtime_error se o arquivo não pode ser gravado
+void MatrixFile::writeArrays(const std::string &path, Header header, const void *const *arrays, const size_t *sizes,
+                             const int count, const bool checksum) {
+  std::ofstream output(path, std::ios::binary | std::ios::trunc);
+  if (!output) {
+    fail(path, "nao foi possivel criar o arquivo");
+  }
+  output.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+  static constexpr char zeros[ALIGNMENT] = {};
+  Checksum sum;
+  for (int a = 0; a < count; a++) {
+    const size_t padding = align(sizes[a]) - sizes[a];
+    output.write(static_cast<const char *>(arrays[a]), static_cast<std::streamsize>(sizes[a]));
+    output.write(zeros, static_cast<std::streamsize>(padding));
+    if (checksum) {
+      sum.update(arrays[a], sizes[a]);
+      sum.update(zeros, padding);
+    }
+  }
+
+  if (checksum) {
+    header.flags |= HAS_CHECKSUM;
+    header.checksum = sum.value();
+  }
+  output.seekp(0);
+  output.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  if (!output) {
+    fail(path, "erro de escrita");
+  }
+}
+
+void MatrixFile::write(const std::string &path, const SparseMatrixCSR &A, const bool checksum) {
+  const size_t majors = static_cast<size_t>(A.isColumnMajor() ? A.cols() : A.rows());
+  const Header header = makeHeader(A.isColumnMajor() ? Kind::CSC : Kind::CSR, A.rows(), A.cols(), A.nnz());
+  const void *arrays[] = {A.offsetData(), A.indexData(), A.valueData()};
+  const size_t sizes[] = {(majors + 1) * sizeof(int), A.nnz() * sizeof(int), A.nnz() * sizeof(double)};
+  writeArrays(path, header, arrays, sizes, 3, checksum);
+}
+
+void MatrixFile::write(const std::string &path, const SparseMatrixHash &A, const bool checksum) {
+  write(path, SparseMatrixCSR::fromHash(A), checksum);
+}
+
+/// @brief Grava a matriz lógica da árvore; uma árvore transposta é gravada na forma CSC, sem reordenar
+void MatrixFile::write(const std::string &path, SparseMatrixTree::TreeNode *root, const int n, const int m,
+                       const bool transpose, const bool checksum) {
+  write(path, SparseMatrixCSR::fromTree(root, n, m, transpose), checksum);
+}
+
+/// @brief Grava os elementos guardados diretamente; um fator de escala pendente é antes aplicado a uma cópia
+void MatrixFile::write(const std::string &path, const DenseMatrix &A, const bool checksum) {
+  if (A.scaleFactor() != 1.0) {
+    DenseMatrix scaled = A;
+    scaled.materialize();
+    write(path, scaled, checksum);
+    return;
+  }
+
+  const size_t count = static_cast<size_t>(A.rows()) * A.cols();
+  const Header header = makeHeader(Kind::DENSE, A.rows(), A.cols(), count);
+  const void *arrays[] = {count > 0 ? A.rowData(0) : nullptr};
+  const size_t sizes[] = {count * sizeof(double)};
+  writeArrays(path, header, arrays, sizes, 1, checksum);
+}
+
+/// @brief Lê só o cabeçalho do arquivo
+/// @throws std::runtime_error se o arquivo não existe ou não está no formato
+MatrixFile::Header MatrixFile::readHeader(const std::string &path) {
+  std::ifstream input(path, std::ios::binary);
+  Header header{};
+  if (!input.read(reinterpret_cast<char *>(&header), sizeof(header))) {
+    fail(path, "arquivo ausente ou menor que o cabecalho");
+  }
+  if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) {
+    fail(path, "nao e um arquivo de matriz");
+  }
+  if (header.version != VERSION) {
+    fail(path, "versao " + std::to_string(header.version) + " nao suportada");
+  }
+  if (header.indexBytes != sizeof(int) || header.valueBytes != sizeof(double)) {
+    fail(path, "tipos de indice ou valor incompativeis");
+  }
+  if (header.rows < 0 || header.cols < 0 || header.rows > INT_MAX || header.cols > INT_MAX) {
+    fail(path, "dimensoes invalidas");
+  }
+  return header;
+}
+
+namespace {
+  /// @brief Mapeia o arquivo e confere cabeçalho, tamanho e, se pedido, a soma de verificação
+  std::shared_ptr<const MappedFile> openChecked(const std::string &path, const MatrixFile::Header &header,
+                                                const size_t expectedSize, const bool verify) {
+    std::shared_ptr<const MappedFile> file = MappedFile::open(path);
+    if (file->size() < expectedSize) {
+      fail(path, "arquivo truncado");
+    }
+    if (std::memcmp(file->data(), &header, sizeof(header)) != 0) {
+      fail(path, "arquivo alterado durante a leitura");
+    }
+    if (verify && (header.flags & MatrixFile::HAS_CHECKSUM) != 0) {
+      Checksum sum;
+      sum.update(file->data() + sizeof(header), expectedSize - sizeof(header));
+      if (sum.value() != header.checksum) {
+        fail(path, "soma de verificacao nao confere");
+      }
+    }
+    return file;
+  }
+}
+
+/// @brief Mapeia um arquivo esparso e devolve a matriz que lê os vetores direto do mapeamento
+/// @param verify confere a soma de verificação
+/// @param checkArrays confere que os deslocamentos não decrescem e que os índices estão dentro da dimensão menor
+SparseMatrixCSR MatrixFile::mapSparse(const std::string &path, const bool verify, const bool checkArrays,
+                                      Header &header) {
+  header = readHeader(path);
+  if (header.kind != Kind::CSR && header.kind != Kind::CSC) {
+    fail(path, "a matriz gravada nao e esparsa");
+  }
+  if (header.nnz > INT_MAX) {
+    fail(path, "nnz maior que o suportado");
+  }
+
+  const bool byColumn = header.kind == Kind::CSC;
+  const size_t majors = static_cast<size_t>(byColumn ? header.cols : header.rows);
+  const size_t offsetsAt = sizeof(Header);
+  const size_t indicesAt = offsetsAt + align((majors + 1) * sizeof(int));
+  const size_t valuesAt = indicesAt + align(header.nnz * sizeof(int));
+  const size_t end = valuesAt + align(header.nnz * sizeof(double));
+
+  const std::shared_ptr<const MappedFile> file = openChecked(path, header, end, verify);
+  const auto *offsets = reinterpret_cast<const int *>(file->data() + offsetsAt);
+  if (offsets[0] != 0 || offsets[majors] < 0 || static_cast<std::uint64_t>(offsets[majors]) != header.nnz) {
+    fail(path, "deslocamentos inconsistentes com nnz");
+  }
+
+  const auto *indices = reinterpret_cast<const int *>(file->data() + indicesAt);
+  if (checkArrays) {
+    const int minor = static_cast<int>(byColumn ? header.rows : header.cols);
+    for (size_t p = 0; p < majors; p++) {
+      if (offsets[p] > offsets[p + 1]) {
+        fail(path, "deslocamentos decrescentes");
+      }
+    }
+    for (size_t q = 0; q < header.nnz; q++) {
+      if (indices[q] < 0 || indices[q] >= minor) {
+        fail(path, "indice fora da matriz");
+      }
+    }
+  }
+
+  return SparseMatrixCSR::view(static_cast<int>(header.rows), static_cast<int>(header.cols), byColumn, offsets,
+                               indices, reinterpret_cast<const double *>(file->data() + valuesAt), file);
+}
+
+/// @brief Carrega uma matriz esparsa sem copiar nem interpretar os vetores: a matriz devolvida lê o arquivo
+///        mapeado, que fica aberto enquanto ela (ou uma cópia) existir
+/// @param verify confere a soma de verificação, os deslocamentos e os índices, o que exige ler o arquivo inteiro.
+///        Sem ele, índices corrompidos num arquivo não confiável fazem a matriz ler fora dos vetores
+/// @throws std::runtime_error se o arquivo não existe, está truncado ou não guarda uma matriz esparsa válida
+SparseMatrixCSR MatrixFile::loadCSR(const std::string &path, const bool verify) {
+  Header header{};
+  return mapSparse(path, verify, verify, header);
+}
+
+/// @brief Carrega uma matriz esparsa na tabela hash, reservando a capacidade final antes de inserir.
+///        Uma matriz gravada em CSC vira uma tabela transposta, com as chaves na mesma ordem do arquivo.
+///        Deslocamentos e índices são sempre conferidos, e zeros guardados no arquivo são descartados
+/// @param verify confere a soma de verificação
+SparseMatrixHash MatrixFile::loadHash(const std::string &path, const bool verify) {
+  Header header{};
+  const SparseMatrixCSR A = mapSparse(path, verify, true, header);
+  const int majors = A.isColumnMajor() ? A.cols() : A.rows();
+  const int *offsets = A.offsetData();
+  const int *indices = A.indexData();
+  const double *values = A.valueData();
+
+  FlatHashMap data;
+  data.reserve(A.nnz());
+  for (int p = 0; p < majors; p++) {
+    for (int q = offsets[p]; q < offsets[p + 1]; q++) {
+      if (values[q] != 0.0) {
+        data[FlatHashMap::pack(p, indices[q])] = values[q];
+      }
+    }
+  }
+
+  return SparseMatrixHash(A.rows(), A.cols(), A.isColumnMajor(), std::move(data));
+}
+
+/// @brief Carrega uma matriz esparsa na árvore (orientação normal) com a construção linear a partir de
+///        elementos ordenados, sem inserções uma a uma. Deslocamentos e índices são sempre conferidos, e
+///        zeros guardados no arquivo são descartados
+/// @param verify confere a soma de verificação
+SparseMatrixTree::TreeNode *MatrixFile::loadTree(SparseMatrixTree::NodeArena &arena, const std::string &path,
+                                                 const bool verify) {
+  Header header{};
+  const SparseMatrixCSR A = mapSparse(path, verify, true, header).toRowMajor();
+
+  std::vector<std::tuple<int, int, double> > entries;
+  entries.reserve(A.nnz());
+  for (int i = 0; i < A.rows(); i++) {
+    const SparseMatrixCSR::Slice row = A.row(i);
+    for (int p = 0; p < row.size; p++) {
+      if (row.value[p] != 0.0) {
+        entries.emplace_back(i, row.index[p], row.value[p]);
+      }
+    }
+  }
+
+  return SparseMatrixTree::buildFromSorted(arena, entries);
+}
+
+/// @brief Carrega uma matriz densa com uma única cópia em bloco do conteúdo
+DenseMatrix MatrixFile::loadDense(const std::string &path, const bool verify) {
+  const Header header = readHeader(path);
+  if (header.kind != Kind::DENSE) {
+    fail(path, "a matriz gravada nao e densa");
+  }
+
+  const size_t count = static_cast<size_t>(header.rows) * static_cast<size_t>(header.cols);
+  const size_t end = sizeof(Header) + align(count * sizeof(double));
+  const std::shared_ptr<const MappedFile> file = openChecked(path, header, end, verify);
+
+  DenseMatrix A(static_cast<int>(header.rows), static_cast<int>(header.cols));
+  if (count > 0) {
+    std::memcpy(A.rowData(0), file->data() + sizeof(Header), count * sizeof(double));
+  }
+  return A;
+}
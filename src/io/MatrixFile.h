@@ -0,0 +1,73 @@
+#ifndef MC458_PROJETO_MATRIXFILE_H
+#define MC458_PROJETO_MATRIXFILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "../data_structures/dense_matrix/DenseMatrix.h"
+#include "../data_structures/sparse_matrix_csr/SparseMatrixCSR.h"
+#include "../data_structures/sparse_matrix_hash/SparseMatrixHash.h"
+#include "../data_structures/sparse_matrix_tree/SparseMatrixTree.h"
+
+// Formato binário versionado de matrizes: um cabeçalho de 64 bytes seguido dos vetores, cada um começando
+// em um múltiplo de 64 bytes. Esparsas guardam a forma CSR (ou CSC): deslocamentos (int32, linhas + 1),
+// índices (int32, nnz) e valores (double, nnz). Densas guardam rows * cols valores por linhas.
+// Os vetores estão na representação da máquina, então um arquivo mapeado é lido direto pela SparseMatrixCSR.
+// loadHash e loadTree, que copiam os elementos, sempre conferem deslocamentos e índices; loadCSR só o faz com
+// verify, e a visão sem verificação de um arquivo não confiável pode ler fora dos vetores
+class MatrixFile {
+public:
+  enum class Kind : std::uint32_t {
+    CSR = 1, CSC = 2, DENSE = 3
+  };
+
+  struct Header {
+    char magic[8];
+    std::uint32_t version;
+    Kind kind;
+    std::int64_t rows, cols;
+    std::uint64_t nnz;
+    std::uint64_t checksum; // do conteúdo após o cabeçalho, se HAS_CHECKSUM
+    std::uint16_t indexBytes, valueBytes;
+    std::uint32_t flags;
+    std::uint64_t reserved;
+  };
+
+  static constexpr std::uint32_t VERSION = 1;
+  static constexpr std::uint32_t HAS_CHECKSUM = 1;
+
+  static void write(const std::string &path, const SparseMatrixCSR &A, bool checksum = true);
+
+  static void write(const std::string &path, const SparseMatrixHash &A, bool checksum = true);
+
+  static void write(const std::string &path, SparseMatrixTree::TreeNode *root, int n, int m, bool transpose,
+                    bool checksum = true);
+
+  static void write(const std::string &path, const DenseMatrix &A, bool checksum = true);
+
+  static Header readHeader(const std::string &path);
+
+  static SparseMatrixCSR loadCSR(const std::string &path, bool verify = false);
+
+  static SparseMatrixHash loadHash(const std::string &path, bool verify = false);
+
+  static SparseMatrixTree::TreeNode *loadTree(SparseMatrixTree::NodeArena &arena, const std::string &path,
+                                              bool verify = false);
+
+  static DenseMatrix loadDense(const std::string &path, bool verify = false);
+
+private:
+  static constexpr size_t ALIGNMENT = 64;
+
+  static size_t align(size_t offset);
+
+  static Header makeHeader(Kind kind, int rows, int cols, std::uint64_t nnz);
+
+  static void writeArrays(const std::string &path, Header header, const void *const *arrays, const size_t *sizes,
+                          int count, bool checksum);
+
+  static SparseMatrixCSR mapSparse(const std::string &path, bool verify, bool checkArrays, Header &header);
+};
+
+#endif //MC458_PROJETO_MATRIXFILE_H
@@ -0,0 +1,462 @@
+#include "MatrixMarket.h"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+  constexpr size_t CHUNK_BYTES = size_t{1} << 25;
+  constexpr size_t WRITE_BUFFER_BYTES = size_t{1} << 22;
+
+  [[noreturn]] void fail(const std::string &path, const std::string &reason) {
+    throw std::runtime_error(path + ": " + reason);
+  }
+
+  std::string lowercase(std::string text) {
+    std::transform(text.begin(), text.end(), text.begin(),
+                   [](const unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return text;
+  }
+
+  /// @brief Abre o arquivo e interpreta o cabeçalho (banner, comentários e linha de tamanhos)
+  /// @return fluxo posicionado no início dos dados
+  std::ifstream openBody(const std::string &path, MatrixMarket::Header &header) {
+    std::ifstream input(path, std::ios::binary);
+    std::string line;
+    if (!input || !std::getline(input, line)) {
+      fail(path, "nao foi possivel ler o arquivo");
+    }
+
+    std::istringstream banner(lowercase(line));
+    std::string tag, object, format, field, symmetry;
+    banner >> tag >> object >> format >> field >> symmetry;
+    if (tag != "%%matrixmarket" || object != "matrix") {
+      fail(path, "cabecalho Matrix Market ausente");
+    }
+
+    if (format == "coordinate") {
+      header.format = MatrixMarket::Format::COORDINATE;
+    } else if (format == "array") {
+      header.format = MatrixMarket::Format::ARRAY;
+    } else {
+      fail(path, "formato '" + format + "' nao suportado");
+    }
+
+    if (field == "real" || field == "double") {
+      header.field = MatrixMarket::Field::REAL;
+    } else if (field == "integer") {
+      header.field = MatrixMarket::Field::INTEGER;
+    } else if (field == "pattern" && header.format == MatrixMarket::Format::COORDINATE) {
+      header.field = MatrixMarket::Field::PATTERN;
+    } else {
+      fail(path, "campo '" + field + "' nao suportado");
+    }
+
+    if (symmetry == "general") {
+      header.symmetry = MatrixMarket::Symmetry::GENERAL;
+    } else if (symmetry == "symmetric") {
+      header.symmetry = MatrixMarket::Symmetry::SYMMETRIC;
+    } else if (symmetry == "skew-symmetric") {
+      header.symmetry = MatrixMarket::Symmetry::SKEW_SYMMETRIC;
+    } else {
+      fail(path, "simetria '" + symmetry + "' nao suportada");
+    }
+
+    while (std::getline(input, line)) {
+      const size_t first = line.find_first_not_of(" \t\r");
+      if (first == std::string::npos || line[first] == '%') {
+        continue;
+      }
+
+      std::istringstream sizes(line);
+      long long rows = -1, cols = -1, entries = -1;
+      sizes >> rows >> cols;
+      if (header.format == MatrixMarket::Format::COORDINATE) {
+        sizes >> entries;
+      } else {
+        entries = header.symmetry == MatrixMarket::Symmetry::GENERAL
+                    ? rows * cols
+                    : header.symmetry == MatrixMarket::Symmetry::SYMMETRIC
+                        ? rows * (rows + 1) / 2
+                        : rows * (rows - 1) / 2;
+      }
+      if (!sizes || rows < 0 || cols < 0 || entries < 0 || rows > INT32_MAX || cols > INT32_MAX
+          || (header.symmetry != MatrixMarket::Symmetry::GENERAL && rows != cols)) {
+        fail(path, "linha de dimensoes invalida");
+      }
+      header.rows = static_cast<int>(rows);
+      header.cols = static_cast<int>(cols);
+      header.entries = entries;
+      return input;
+    }
+
+    fail(path, "linha de dimensoes ausente");
+  }
+
+  const char *skipBlanks(const char *p, const char *end) {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) {
+      p++;
+    }
+    return p;
+  }
+
+  /// @brief Interpreta um número como std::from_chars, aceitando também um '+' inicial, como o scanf
+  template<typename Number>
+  std::from_chars_result parseNumber(const char *p, const char *end, Number &value) {
+    if (end - p > 1 && p[0] == '+' && p[1] != '-' && p[1] != '+') {
+      p++;
+    }
+    return std::from_chars(p, end, value);
+  }
+
+  /// @brief Lê o corpo em blocos de linhas completas. Cada bloco é dividido em faixas que parse interpreta
+  ///        em paralelo, cada uma em seu resultado local; consume recebe os resultados na ordem do arquivo
+  /// @param parse (início, fim, local, linhas) -> nulo, ou o início da linha inválida
+  template<typename Local, typename Parse, typename Consume>
+  long long streamChunks(std::istream &input, ThreadPool &pool, const std::string &path, Parse parse,
+                         Consume consume) {
+    std::vector<char> buffer(CHUNK_BYTES);
+    const int pieces = pool.size() * 4;
+    std::vector<Local> locals(pieces);
+    std::vector<long long> lines(pieces);
+    std::vector<const char *> errors(pieces);
+    std::vector<size_t> bounds(pieces + 1);
+    size_t carried = 0;
+    long long totalLines = 0;
+
+    while (true) {
+      input.read(buffer.data() + carried, static_cast<std::streamsize>(buffer.size() - carried));
+      const size_t filled = carried + static_cast<size_t>(input.gcount());
+      const bool last = filled < buffer.size();
+
+      size_t cut = filled;
+      if (!last) {
+        while (cut > 0 && buffer[cut - 1] != '\n') {
+          cut--;
+        }
+        if (cut == 0) {
+          // Uma linha maior que o bloco inteiro: aumenta o bloco e continua lendo
+          buffer.resize(buffer.size() * 2);
+          carried = filled;
+          continue;
+        }
+      }
+
+      bounds[0] = 0;
+      bounds[pieces] = cut;
+      for (int p = 1; p < pieces; p++) {
+        size_t pos = std::max(cut * p / pieces, bounds[p - 1]);
+        while (pos > 0 && pos < cut && buffer[pos - 1] != '\n') {
+          pos++;
+        }
+        bounds[p] = pos;
+      }
+
+      pool.run(pieces, [&](const int p) {
+        locals[p].clear();
+        lines[p] = 0;
+        errors[p] = parse(buffer.data() + bounds[p], buffer.data() + bounds[p + 1], locals[p], lines[p]);
+      });
+
+      for (int p = 0; p < pieces; p++) {
+        if (errors[p] != nullptr) {
+          const char *lineEnd = std::find(errors[p], static_cast<const char *>(buffer.data() + cut), '\n');
+          fail(path, "linha invalida: '" + std::string(errors[p], lineEnd) + "'");
+        }
+        totalLines += lines[p];
+        consume(locals[p]);
+      }
+
+      if (last) {
+        return totalLines;
+      }
+      std::copy(buffer.begin() + static_cast<std::ptrdiff_t>(cut), buffer.begin() + static_cast<std::ptrdiff_t>(filled),
+                buffer.begin());
+      carried = filled - cut;
+    }
+  }
+
+  /// @brief Interpreta as linhas de valores de uma faixa do formato array
+  const char *parseValues(const char *begin, const char *end, std::vector<double> &values, long long &lines) {
+    for (const char *p = begin; p < end;) {
+      const char *lineEnd = static_cast<const char *>(std::memchr(p, '\n', end - p));
+      lineEnd = lineEnd != nullptr ? lineEnd : end;
+
+      if (const char *q = skipBlanks(p, lineEnd); q < lineEnd && *q != '%') {
+        double value;
+        const auto [next, error] = parseNumber(q, lineEnd, value);
+        if (error != std::errc{} || skipBlanks(next, lineEnd) != lineEnd) {
+          return p;
+        }
+        values.push_back(value);
+        lines++;
+      }
+      p = lineEnd + 1;
+    }
+    return nullptr;
+  }
+
+  /// @brief Escrita em blocos: os números são formatados com to_chars em um buffer que é gravado quando enche
+  class BufferedWriter {
+    std::ofstream output;
+    std::vector<char> buffer;
+    size_t used = 0;
+    std::string path;
+
+    void reserve(const size_t bytes) {
+      if (used + bytes > buffer.size()) {
+        flush();
+      }
+    }
+
+  public:
+    explicit BufferedWriter(const std::string &path)
+      : output(path, std::ios::binary | std::ios::trunc), buffer(WRITE_BUFFER_BYTES), path(path) {
+      if (!output) {
+        fail(path, "nao foi possivel criar o arquivo");
+      }
+    }
+
+    void flush() {
+      output.write(buffer.data(), static_cast<std::streamsize>(used));
+      used = 0;
+      if (!output) {
+        fail(path, "erro de escrita");
+      }
+    }
+
+    BufferedWriter &operator<<(const std::string &text) {
+      reserve(text.size());
+      std::copy(text.begin(), text.end(), buffer.begin() + static_cast<std::ptrdiff_t>(used));
+      used += text.size();
+      return *this;
+    }
+
+    BufferedWriter &operator<<(const char c) {
+      reserve(1);
+      buffer[used++] = c;
+      return *this;
+    }
+
+    template<typename Number>
+    BufferedWriter &operator<<(const Number value) {
+      reserve(32);
+      used = std::to_chars(buffer.data() + used, buffer.data() + buffer.size(), value).ptr - buffer.data();
+      return *this;
+    }
+  };
+}
+
+/// @brief Lê só o cabeçalho e as dimensões do arquivo
+/// @throws std::runtime_error se o arquivo não existe ou não está em um formato suportado
+MatrixMarket::Header MatrixMarket::readHeader(const std::string &path) {
+  Header header{};
+  openBody(path, header);
+  return header;
+}
+
+/// @brief Lê os elementos do arquivo como triplas com índices a partir de 0. Elementos simétricos implícitos
+///        são gerados (com sinal trocado se antissimétrica); pattern vale 1; o formato array gera os não nulos
+/// @param header preenchido com o cabeçalho lido
+/// @param pool conjunto de threads que interpreta cada bloco
+/// @throws std::runtime_error se o arquivo não existe, tem linhas inválidas ou um número errado de elementos
+std::vector<std::tuple<int, int, double> > MatrixMarket::readTriplets(const std::string &path, Header &header,
+                                                                      ThreadPool &pool) {
+  std::ifstream input = openBody(path, header);
+  std::vector<std::tuple<int, int, double> > entries;
+
+  if (header.format == Format::ARRAY) {
+    const DenseMatrix A = loadDense(path, pool);
+    for (int i = 0; i < A.rows(); i++) {
+      const double *row = A.rowData(i);
+      for (int j = 0; j < A.cols(); j++) {
+        if (row[j] != 0.0) {
+          entries.emplace_back(i, j, row[j]);
+        }
+      }
+    }
+    return entries;
+  }
+
+  const bool pattern = header.field == Field::PATTERN;
+  const bool mirror = header.symmetry != Symmetry::GENERAL;
+  const double mirrorSign = header.symmetry == Symmetry::SKEW_SYMMETRIC ? -1.0 : 1.0;
+  const int rows = header.rows, cols = header.cols;
+  entries.reserve(static_cast<size_t>(header.entries) * (mirror ? 2 : 1));
+
+  using Local = std::vector<std::tuple<int, int, double> >;
+  const long long lines = streamChunks<Local>(input, pool, path,
+    [&](const char *begin, const char *end, Local &local, long long &count) -> const char * {
+      for (const char *p = begin; p < end;) {
+        const char *lineEnd = static_cast<const char *>(std::memchr(p, '\n', end - p));
+        lineEnd = lineEnd != nullptr ? lineEnd : end;
+
+        if (const char *q = skipBlanks(p, lineEnd); q < lineEnd && *q != '%') {
+          int i = 0, j = 0;
+          double value = 1.0;
+          auto result = parseNumber(q, lineEnd, i);
+          if (result.ec == std::errc{}) {
+            result = parseNumber(skipBlanks(result.ptr, lineEnd), lineEnd, j);
+          }
+          if (result.ec == std::errc{} && !pattern) {
+            const auto [next, error] = parseNumber(skipBlanks(result.ptr, lineEnd), lineEnd, value);
+            result = {next, error};
+          }
+          if (result.ec != std::errc{} || skipBlanks(result.ptr, lineEnd) != lineEnd || i < 1 || i > rows || j < 1 ||
+              j > cols) {
+            return p;
+          }
+
+          local.emplace_back(i - 1, j - 1, value);
+          if (mirror && i != j) {
+            local.emplace_back(j - 1, i - 1, mirrorSign * value);
+          }
+          count++;
+        }
+        p = lineEnd + 1;
+      }
+      return nullptr;
+    },
+    [&](Local &local) {
+      entries.insert(entries.end(), local.begin(), local.end());
+    });
+
+  if (lines != header.entries) {
+    fail(path, "esperados " + std::to_string(header.entries) + " elementos, lidos " + std::to_string(lines));
+  }
+  return entries;
+}
+
+/// @brief Lê o arquivo para a forma CSR, ordenada por contagem; elementos repetidos são somados
+SparseMatrixCSR MatrixMarket::loadCSR(const std::string &path, ThreadPool &pool) {
+  Header header{};
+  const auto entries = readTriplets(path, header, pool);
+  return SparseMatrixCSR::fromTriplets(header.rows, header.cols, entries);
+}
+
+/// @brief Lê o arquivo para a tabela hash, reservando a capacidade final antes de inserir. Elementos
+///        repetidos são somados, e as posições que terminam com zero são retiradas, como em set
+SparseMatrixHash MatrixMarket::loadHash(const std::string &path, ThreadPool &pool) {
+  Header header{};
+  const auto entries = readTriplets(path, header, pool);
+
+  FlatHashMap data;
+  data.reserve(entries.size());
+  for (const auto &[i, j, value]: entries) {
+    data[FlatHashMap::pack(i, j)] += value;
+  }
+  for (const auto &[i, j, value]: entries) {
+    if (const double *sum = data.find(FlatHashMap::pack(i, j)); sum != nullptr && *sum == 0.0) {
+      data.erase(FlatHashMap::pack(i, j));
+    }
+  }
+  return SparseMatrixHash(header.rows, header.cols, false, std::move(data));
+}
+
+/// @brief Lê o arquivo para a árvore: as triplas são ordenadas por contagem (via CSR, que soma as repetidas e
+///        descarta os zeros) e a árvore é montada pela construção linear a partir de elementos ordenados
+SparseMatrixTree::TreeNode *MatrixMarket::loadTree(SparseMatrixTree::NodeArena &arena, const std::string &path,
+                                                   ThreadPool &pool) {
+  const SparseMatrixCSR A = loadCSR(path, pool);
+
+  std::vector<std::tuple<int, int, double> > entries;
+  entries.reserve(A.nnz());
+  for (int i = 0; i < A.rows(); i++) {
+    const SparseMatrixCSR::Slice row = A.row(i);
+    for (int p = 0; p < row.size; p++) {
+      entries.emplace_back(i, row.index[p], row.value[p]);
+    }
+  }
+  return SparseMatrixTree::buildFromSorted(arena, entries);
+}
+
+/// @brief Lê o arquivo para a matriz densa. No formato array os valores vêm por colunas (só o triângulo
+///        inferior se simétrica); no formato coordinate os elementos são somados às posições
+DenseMatrix MatrixMarket::loadDense(const std::string &path, ThreadPool &pool) {
+  Header header{};
+  std::ifstream input = openBody(path, header);
+  DenseMatrix A(header.rows, header.cols);
+
+  if (header.format == Format::COORDINATE) {
+    input.close();
+    for (const auto &[i, j, value]: readTriplets(path, header, pool)) {
+      A.rowData(i)[j] += value;
+    }
+    return A;
+  }
+
+  std::vector<double> values;
+  values.reserve(static_cast<size_t>(header.entries));
+  const long long lines = streamChunks<std::vector<double> >(input, pool, path, parseValues,
+                                                             [&](std::vector<double> &local) {
+                                                               values.insert(values.end(), local.begin(), local.end());
+                                                             });
+  if (lines != header.entries) {
+    fail(path, "esperados " + std::to_string(header.entries) + " valores, lidos " + std::to_string(lines));
+  }
+
+  const double mirrorSign = header.symmetry == Symmetry::SKEW_SYMMETRIC ? -1.0 : 1.0;
+  size_t t = 0;
+  for (int j = 0; j < header.cols; j++) {
+    const int first = header.symmetry == Symmetry::GENERAL ? 0 : header.symmetry == Symmetry::SYMMETRIC ? j : j + 1;
+    for (int i = first; i < header.rows; i++) {
+      A.rowData(i)[j] = values[t];
+      if (header.symmetry != Symmetry::GENERAL && i != j) {
+        A.rowData(j)[i] = mirrorSign * values[t];
+      }
+      t++;
+    }
+  }
+  return A;
+}
+
+/// @brief Grava no formato coordinate real general, com índices a partir de 1 e valores em representação
+///        decimal mínima que relê o mesmo double
+/// @throws std::runtime_error se o arquivo não pode ser gravado
+void MatrixMarket::write(const std::string &path, const SparseMatrixCSR &A) {
+  BufferedWriter output(path);
+  output << std::string("%%MatrixMarket matrix coordinate real general\n")
+      << A.rows() << ' ' << A.cols() << ' ' << A.nnz() << '\n';
+
+  const int majors = A.isColumnMajor() ? A.cols() : A.rows();
+  const int *offsets = A.offsetData();
+  const int *indices = A.indexData();
+  const double *values = A.valueData();
+  for (int p = 0; p < majors; p++) {
+    for (int q = offsets[p]; q < offsets[p + 1]; q++) {
+      const int i = A.isColumnMajor() ? indices[q] : p;
+      const int j = A.isColumnMajor() ? p : indices[q];
+      output << i + 1 << ' ' << j + 1 << ' ' << values[q] << '\n';
+    }
+  }
+  output.flush();
+}
+
+void MatrixMarket::write(const std::string &path, const SparseMatrixHash &A) {
+  write(path, SparseMatrixCSR::fromHash(A));
+}
+
+void MatrixMarket::write(const std::string &path, SparseMatrixTree::TreeNode *root, const int n, const int m,
+                         const bool transpose) {
+  write(path, SparseMatrixCSR::fromTree(root, n, m, transpose));
+}
+
+/// @brief Grava no formato array real general (valores por colunas)
+void MatrixMarket::write(const std::string &path, const DenseMatrix &A) {
+  BufferedWriter output(path);
+  output << std::string("%%MatrixMarket matrix array real general\n") << A.rows() << ' ' << A.cols() << '\n';
+
+  for (int j = 0; j < A.cols(); j++) {
+    for (int i = 0; i < A.rows(); i++) {
+      output << A.get(i, j) << '\n';
+    }
+  }
+  output.flush();
+}
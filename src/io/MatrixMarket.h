@@ -0,0 +1,62 @@
+#ifndef MC458_PROJETO_MATRIXMARKET_H
+#define MC458_PROJETO_MATRIXMARKET_H
+
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "../data_structures/dense_matrix/DenseMatrix.h"
+#include "../data_structures/sparse_matrix_csr/SparseMatrixCSR.h"
+#include "../data_structures/sparse_matrix_hash/SparseMatrixHash.h"
+#include "../data_structures/sparse_matrix_tree/SparseMatrixTree.h"
+#include "../parallel/ThreadPool.h"
+
+// Leitura e escrita de arquivos Matrix Market (.mtx, formato texto do SuiteSparse). O corpo do arquivo é
+// lido em blocos; cada bloco é dividido em faixas de linhas completas, interpretadas em paralelo com
+// from_chars, e o resultado alimenta a construção em bloco de cada estrutura
+class MatrixMarket {
+public:
+  enum class Format {
+    COORDINATE, ARRAY
+  };
+
+  enum class Field {
+    REAL, INTEGER, PATTERN
+  };
+
+  enum class Symmetry {
+    GENERAL, SYMMETRIC, SKEW_SYMMETRIC
+  };
+
+  struct Header {
+    Format format;
+    Field field;
+    Symmetry symmetry;
+    int rows, cols;
+    long long entries; // linhas de dados no arquivo (sem as simétricas implícitas)
+  };
+
+  static Header readHeader(const std::string &path);
+
+  static std::vector<std::tuple<int, int, double> > readTriplets(const std::string &path, Header &header,
+                                                                 ThreadPool &pool = ThreadPool::shared());
+
+  static SparseMatrixCSR loadCSR(const std::string &path, ThreadPool &pool = ThreadPool::shared());
+
+  static SparseMatrixHash loadHash(const std::string &path, ThreadPool &pool = ThreadPool::shared());
+
+  static SparseMatrixTree::TreeNode *loadTree(SparseMatrixTree::NodeArena &arena, const std::string &path,
+                                              ThreadPool &pool = ThreadPool::shared());
+
+  static DenseMatrix loadDense(const std::string &path, ThreadPool &pool = ThreadPool::shared());
+
+  static void write(const std::string &path, const SparseMatrixCSR &A);
+
+  static void write(const std::string &path, const SparseMatrixHash &A);
+
+  static void write(const std::string &path, SparseMatrixTree::TreeNode *root, int n, int m, bool transpose);
+
+  static void write(const std::string &path, const DenseMatrix &A);
+};
+
+#endif //MC458_PROJETO_MATRIXMARKET_H
@@ -0,0 +1,50 @@
+#ifndef MC458_PROJETO_PARALLELACCUMULATE_H
+#define MC458_PROJETO_PARALLELACCUMULATE_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+#include "ThreadPool.h"
+
+/// @brief Executa tarefas que espalham somas em posições arbitrárias de um vetor de saída: no máximo
+///        pool.size() trabalhadores pegam as tarefas em ordem e cada um acumula as suas em um único vetor
+///        local zerado; ao final, os vetores locais são somados em out por faixas, em paralelo e sem trava
+/// @param pool conjunto de threads
+/// @param tasks número de tarefas
+/// @param size tamanho do vetor de saída
+/// @param out vetor de saída (os valores são somados ao conteúdo atual)
+/// @param task função chamada como task(índice, vetor local)
+template<typename T, typename Task>
+void parallelAccumulate(ThreadPool &pool, const int tasks, const size_t size, T *out, Task &&task) {
+  const int workers = std::max(1, std::min(tasks, pool.size()));
+  std::vector<std::vector<T> > local(workers);
+  std::atomic<int> nextTask{0};
+
+  pool.run(workers, [&](const int w) {
+    for (int t = nextTask++; t < tasks; t = nextTask++) {
+      if (local[w].empty()) {
+        local[w].assign(size, T{});
+      }
+      task(t, local[w].data());
+    }
+  });
+
+  const int ranges = pool.size();
+  const size_t step = (size + ranges - 1) / ranges;
+  pool.run(ranges, [&](const int r) {
+    const size_t begin = std::min(size, r * step);
+    const size_t end = std::min(size, begin + step);
+    for (const std::vector<T> &buffer: local) {
+      if (buffer.empty()) {
+        continue;
+      }
+      for (size_t p = begin; p < end; p++) {
+        out[p] += buffer[p];
+      }
+    }
+  });
+}
+
+#endif //MC458_PROJETO_PARALLELACCUMULATE_H
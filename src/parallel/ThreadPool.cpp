@@ -0,0 +1,182 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <utility>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace {
+  // Marca threads que já estão dentro de uma tarefa: um run aninhado é executado em série
+  thread_local bool insideTask = false;
+}
+
+/// @brief Cria o conjunto com o número total de threads dado, contando a thread que chama run
+/// @param threads número de threads (no mínimo 1)
+ThreadPool::ThreadPool(const int threads) {
+  for (int t = 1; t < std::max(threads, 1); t++) {
+    workers.emplace_back([this]() { workerLoop(); });
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  wake.notify_all();
+  for (std::thread &worker: workers) {
+    worker.join();
+  }
+}
+
+/// @brief Número de threads que executam tarefas, incluindo a que chama run
+int ThreadPool::size() const {
+  return static_cast<int>(workers.size()) + 1;
+}
+
+/// @brief Retira e executa a próxima tarefa do lote atual, se houver
+/// @param lock trava do conjunto, mantida na entrada e na saída
+/// @return falso se não havia tarefa a executar
+bool ThreadPool::runNext(std::unique_lock<std::mutex> &lock) {
+  if (job == nullptr || nextTask >= jobTasks) {
+    return false;
+  }
+
+  const int task = nextTask++;
+  const std::function<void(int)> &current = *job;
+  lock.unlock();
+
+  std::exception_ptr error;
+  {
+    // Restaura a marca mesmo se a tarefa lançar, para que os próximos run desta thread não fiquem em série
+    struct TaskScope {
+      bool previous = insideTask;
+
+      TaskScope() {
+        insideTask = true;
+      }
+
+      ~TaskScope() {
+        insideTask = previous;
+      }
+    } scope;
+
+    try {
+      current(task);
+    } catch (...) {
+      error = std::current_exception();
+    }
+  }
+
+  lock.lock();
+  if (error && !failure) {
+    failure = error;
+  }
+  if (--pendingTasks == 0) {
+    finished.notify_all();
+  }
+  return true;
+}
+
+void ThreadPool::workerLoop() {
+  std::unique_lock<std::mutex> lock(mutex);
+  unsigned long seen = generation;
+
+  while (true) {
+    wake.wait(lock, [&]() { return stopping || generation != seen; });
+    if (stopping) {
+      return;
+    }
+    seen = generation;
+    while (runNext(lock)) {
+    }
+  }
+}
+
+/// @brief Executa task(0), ..., task(tasks - 1) distribuídas entre as threads e espera todas terminarem.
+///        A primeira exceção lançada por uma tarefa é relançada depois que o lote termina
+/// @param tasks número de tarefas
+/// @param task função chamada com o índice da tarefa
+void ThreadPool::run(const int tasks, const std::function<void(int)> &task) {
+  if (tasks <= 0) {
+    return;
+  }
+  if (insideTask || workers.empty() || tasks == 1) {
+    for (int t = 0; t < tasks; t++) {
+      task(t);
+    }
+    return;
+  }
+
+  std::unique_lock<std::mutex> lock(mutex);
+  finished.wait(lock, [&]() { return job == nullptr; });
+  job = &task;
+  jobTasks = tasks;
+  nextTask = 0;
+  pendingTasks = tasks;
+  generation++;
+  wake.notify_all();
+
+  while (runNext(lock)) {
+  }
+  finished.wait(lock, [&]() { return pendingTasks == 0; });
+
+  // Só aqui o lote é encerrado, depois de lida a exceção dele, para que outro run não comece antes
+  const std::exception_ptr error = std::exchange(failure, nullptr);
+  job = nullptr;
+  finished.notify_all();
+  lock.unlock();
+
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+/// @brief Fixa cada thread do conjunto em um núcleo, percorrendo em rodízio só os núcleos permitidos à thread
+///        que chama (taskset, cpuset do contêiner): ela fica no permitido de posição firstCpu e o trabalhador t
+///        no de posição firstCpu + t, para que as medições não migrem entre núcleos
+/// @return falso se a plataforma não permite fixar threads ou se alguma fixação falhou
+bool ThreadPool::pinThreads(const int firstCpu) {
+#ifdef __linux__
+  cpu_set_t allowedSet;
+  CPU_ZERO(&allowedSet);
+  if (sched_getaffinity(0, sizeof(allowedSet), &allowedSet) != 0) {
+    return false;
+  }
+  std::vector<int> allowed;
+  for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+    if (CPU_ISSET(cpu, &allowedSet)) {
+      allowed.push_back(cpu);
+    }
+  }
+  if (allowed.empty()) {
+    return false;
+  }
+
+  const int cpus = static_cast<int>(allowed.size());
+  auto pin = [&](const pthread_t thread, const int offset) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(allowed[((firstCpu + offset) % cpus + cpus) % cpus], &set);
+    return pthread_setaffinity_np(thread, sizeof(set), &set) == 0;
+  };
+
+  bool pinned = pin(pthread_self(), 0);
+  for (size_t t = 0; t < workers.size(); t++) {
+    pinned = pin(workers[t].native_handle(), static_cast<int>(t) + 1) && pinned;
+  }
+  return pinned;
+#else
+  (void) firstCpu;
+  return false;
+#endif
+}
+
+/// @brief Conjunto compartilhado pelo processo, com uma thread por núcleo disponível
+ThreadPool &ThreadPool::shared() {
+  static ThreadPool pool;
+  return pool;
+}
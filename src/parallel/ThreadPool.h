@@ -0,0 +1,46 @@
+#ifndef MC458_PROJETO_THREADPOOL_H
+#define MC458_PROJETO_THREADPOOL_H
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Conjunto fixo de threads que executa lotes de tarefas indexadas. A thread que chama run
+// também executa tarefas e só retorna quando o lote inteiro termina; se alguma tarefa lançar uma exceção,
+// as demais ainda são executadas e run relança a primeira.
+class ThreadPool {
+  std::vector<std::thread> workers;
+  std::mutex mutex;
+  std::condition_variable wake, finished;
+  const std::function<void(int)> *job = nullptr;
+  int jobTasks = 0, nextTask = 0, pendingTasks = 0;
+  unsigned long generation = 0;
+  std::exception_ptr failure; // primeira exceção lançada por uma tarefa do lote atual
+  bool stopping = false;
+
+  void workerLoop();
+
+  bool runNext(std::unique_lock<std::mutex> &lock);
+
+public:
+  explicit ThreadPool(int threads = static_cast<int>(std::thread::hardware_concurrency()));
+
+  ThreadPool(const ThreadPool &) = delete;
+
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  ~ThreadPool();
+
+  int size() const;
+
+  void run(int tasks, const std::function<void(int)> &task);
+
+  bool pinThreads(int firstCpu = 0);
+
+  static ThreadPool &shared();
+};
+
+#endif //MC458_PROJETO_THREADPOOL_H
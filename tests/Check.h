@@ -0,0 +1,29 @@
+#ifndef MC458_PROJETO_CHECK_H
+#define MC458_PROJETO_CHECK_H
+
+#include <iostream>
+
+// Verificação dos testes: ao contrário de assert, continua ativa em Release e não interrompe o teste,
+// só conta a falha; o main de cada teste devolve testResult()
+inline int &checkFailures() {
+  static int failures = 0;
+  return failures;
+}
+
+inline int testResult() {
+  if (checkFailures() > 0) {
+    std::cerr << checkFailures() << " verificacoes falharam\n";
+    return 1;
+  }
+  return 0;
+}
+
+#define CHECK(condition)                                                                    \
+  do {                                                                                      \
+    if (!(condition)) {                                                                     \
+      std::cerr << __FILE__ << ":" << __LINE__ << ": falhou: " << #condition << "\n";       \
+      checkFailures()++;                                                                    \
+    }                                                                                       \
+  } while (false)
+
+#endif //MC458_PROJETO_CHECK_H
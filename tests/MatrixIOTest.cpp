@@ -0,0 +1,225 @@
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "Check.h"
+#include "io/MatrixFile.h"
+#include "io/MatrixMarket.h"
+
+// Ida e volta pelo formato binário e pelo Matrix Market em todas as estruturas, arquivos corrompidos (que
+// devem ser recusados sem ler fora dos vetores) e zeros explícitos, que nenhuma estrutura esparsa guarda
+
+namespace {
+  using Triplets = std::vector<std::tuple<int, int, double> >;
+
+  std::string tempPath(const std::string &name) {
+    return (std::filesystem::temp_directory_path() / ("mc458_io_test_" + name)).string();
+  }
+
+  void writeText(const std::string &path, const std::string &text) {
+    std::ofstream output(path, std::ios::binary | std::ios::trunc);
+    output << text;
+  }
+
+  template<typename Value>
+  void poke(const std::string &path, const size_t offset, const Value value) {
+    std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+    file.seekp(static_cast<std::streamoff>(offset));
+    file.write(reinterpret_cast<const char *>(&value), sizeof(value));
+  }
+
+  template<typename Load>
+  bool throws(Load &&load) {
+    try {
+      load();
+    } catch (const std::runtime_error &) {
+      return true;
+    }
+    return false;
+  }
+
+  Triplets treeItems(SparseMatrixTree::TreeNode *root) {
+    Triplets entries;
+    SparseMatrixTree::sortedEntries(root, false, entries);
+    return entries;
+  }
+
+  // Posição dos vetores de uma matriz esparsa gravada, como em MatrixFile (alinhados a 64 bytes)
+  size_t aligned(const size_t bytes) {
+    return (bytes + 63) / 64 * 64;
+  }
+
+  void binaryRoundTrips(const SparseMatrixCSR &A) {
+    const Triplets expected = A.items();
+    const std::string path = tempPath("ida_volta.bin");
+
+    for (const bool byColumn: {false, true}) {
+      MatrixFile::write(path, byColumn ? A.toColumnMajor() : A);
+      CHECK(MatrixFile::loadCSR(path, true).toRowMajor().items() == expected);
+      CHECK(MatrixFile::loadHash(path).toCompressed().items() == expected);
+      SparseMatrixTree::NodeArena arena;
+      CHECK(treeItems(MatrixFile::loadTree(arena, path)) == expected);
+    }
+
+    const SparseMatrixHash H = MatrixFile::loadHash(path);
+    MatrixFile::write(path, H.transpose());
+    CHECK(MatrixFile::loadCSR(path).toRowMajor().items() == A.transpose().toRowMajor().items());
+
+    DenseMatrix D(A.rows(), A.cols());
+    for (const auto &[i, j, value]: expected) {
+      D.set(i, j, value);
+    }
+    D *= 2;
+    MatrixFile::write(path, D);
+    const DenseMatrix loaded = MatrixFile::loadDense(path, true);
+    bool same = loaded.rows() == D.rows() && loaded.cols() == D.cols();
+    for (int i = 0; same && i < D.rows(); i++) {
+      for (int j = 0; j < D.cols(); j++) {
+        same = same && loaded.get(i, j) == D.get(i, j);
+      }
+    }
+    CHECK(same);
+    std::remove(path.c_str());
+  }
+
+  void corruptBinaryFiles() {
+    const SparseMatrixCSR A = SparseMatrixCSR::fromTriplets(4, 5, {{0, 1, 1.0}, {2, 3, 2.0}, {3, 4, 3.0}});
+    const std::string path = tempPath("corrompido.bin");
+    const size_t offsetsAt = sizeof(MatrixFile::Header);
+    const size_t indicesAt = offsetsAt + aligned(5 * sizeof(int));
+    const size_t valuesAt = indicesAt + aligned(3 * sizeof(int));
+
+    // Índice fora da matriz: as cargas que copiam sempre recusam; loadCSR recusa com verify
+    for (const bool byColumn: {false, true}) {
+      MatrixFile::write(path, byColumn ? A.toColumnMajor() : A, false);
+      poke(path, indicesAt + sizeof(int), 1000000);
+      SparseMatrixTree::NodeArena arena;
+      CHECK(throws([&]() { MatrixFile::loadTree(arena, path); }));
+      CHECK(throws([&]() { MatrixFile::loadHash(path); }));
+      CHECK(throws([&]() { MatrixFile::loadCSR(path, true); }));
+    }
+
+    // Deslocamentos decrescentes
+    MatrixFile::write(path, A, false);
+    poke(path, offsetsAt + 1 * sizeof(int), 2);
+    poke(path, offsetsAt + 2 * sizeof(int), 1);
+    CHECK(throws([&]() { MatrixFile::loadHash(path); }));
+    CHECK(throws([&]() { MatrixFile::loadCSR(path, true); }));
+
+    // Último deslocamento diferente de nnz e nnz maior que o suportado
+    MatrixFile::write(path, A, false);
+    poke(path, offsetsAt + 4 * sizeof(int), -1);
+    CHECK(throws([&]() { MatrixFile::loadCSR(path); }));
+    MatrixFile::write(path, A, false);
+    MatrixFile::Header header = MatrixFile::readHeader(path);
+    header.nnz = (std::uint64_t{1} << 32) + 3;
+    poke(path, 0, header);
+    CHECK(throws([&]() { MatrixFile::loadCSR(path); }));
+
+    // Soma de verificação: só conferida com verify
+    MatrixFile::write(path, A);
+    poke(path, valuesAt, 7.0);
+    CHECK(throws([&]() { MatrixFile::loadCSR(path, true); }));
+    CHECK(MatrixFile::loadCSR(path).get(0, 1) == 7.0);
+
+    // Zero guardado no arquivo: a hash e a árvore não o guardam
+    MatrixFile::write(path, A, false);
+    poke(path, valuesAt + sizeof(double), 0.0);
+    CHECK(MatrixFile::loadHash(path).nnz() == 2);
+    SparseMatrixTree::NodeArena arena;
+    CHECK(treeItems(MatrixFile::loadTree(arena, path)).size() == 2);
+    CHECK(arena.size() == 2);
+    std::remove(path.c_str());
+  }
+
+  void matrixMarketRoundTrips(const SparseMatrixCSR &A, ThreadPool &pool) {
+    const Triplets expected = A.items();
+    const std::string path = tempPath("ida_volta.mtx");
+
+    MatrixMarket::write(path, A);
+    CHECK(MatrixMarket::loadCSR(path, pool).items() == expected);
+    CHECK(MatrixMarket::loadHash(path, pool).toCompressed().items() == expected);
+    SparseMatrixTree::NodeArena arena;
+    CHECK(treeItems(MatrixMarket::loadTree(arena, path, pool)) == expected);
+
+    DenseMatrix D(3, 2);
+    D.set(0, 0, 1.5);
+    D.set(2, 1, -4);
+    MatrixMarket::write(path, D);
+    const DenseMatrix loaded = MatrixMarket::loadDense(path, pool);
+    CHECK(loaded.get(0, 0) == 1.5 && loaded.get(2, 1) == -4 && loaded.get(1, 0) == 0);
+    std::remove(path.c_str());
+  }
+
+  void matrixMarketLines(ThreadPool &pool) {
+    const std::string path = tempPath("linhas.mtx");
+    const std::string general = "%%MatrixMarket matrix coordinate real general\n";
+
+    // Zeros explícitos e repetições que se anulam não viram elementos guardados
+    writeText(path, general + "3 3 3\n1 1 0\n2 2 1\n3 3 0.0\n");
+    CHECK(MatrixMarket::loadHash(path, pool).nnz() == 1);
+    CHECK(MatrixMarket::loadCSR(path, pool).nnz() == 1);
+    {
+      SparseMatrixTree::NodeArena arena;
+      CHECK(treeItems(MatrixMarket::loadTree(arena, path, pool)).size() == 1);
+      CHECK(arena.size() == 1);
+    }
+    writeText(path, general + "3 3 3\n1 1 2.5\n1 1 -2.5\n2 3 1\n");
+    CHECK(MatrixMarket::loadHash(path, pool).nnz() == 1);
+    CHECK(MatrixMarket::loadCSR(path, pool).nnz() == 1);
+    {
+      SparseMatrixTree::NodeArena arena;
+      MatrixMarket::loadTree(arena, path, pool);
+      CHECK(arena.size() == 1);
+    }
+
+    // Sinal '+' aceito; lixo no fim da linha, inclusive em pattern, recusado
+    writeText(path, general + "3 3 2\n+1 1 +2\r\n2 3 -1e0 \n");
+    const SparseMatrixCSR plus = MatrixMarket::loadCSR(path, pool);
+    CHECK(plus.get(0, 0) == 2 && plus.get(1, 2) == -1);
+    writeText(path, general + "3 3 1\n1 2 3abc\n");
+    CHECK(throws([&]() { MatrixMarket::loadCSR(path, pool); }));
+    writeText(path, general + "3 3 1\n1 2 +-3\n");
+    CHECK(throws([&]() { MatrixMarket::loadCSR(path, pool); }));
+    writeText(path, "%%MatrixMarket matrix coordinate pattern general\n3 3 1\n1 2 x\n");
+    CHECK(throws([&]() { MatrixMarket::loadCSR(path, pool); }));
+
+    // Simétrica: o triângulo superior é espelhado, menos a diagonal
+    writeText(path, "%%MatrixMarket matrix coordinate pattern symmetric\n3 3 2\n2 1\n3 3\n");
+    const SparseMatrixCSR symmetric = MatrixMarket::loadCSR(path, pool);
+    CHECK(symmetric.nnz() == 3 && symmetric.get(0, 1) == 1 && symmetric.get(1, 0) == 1);
+
+    // Posição fora da matriz e número errado de elementos
+    writeText(path, general + "3 3 1\n4 1 1\n");
+    CHECK(throws([&]() { MatrixMarket::loadCSR(path, pool); }));
+    writeText(path, general + "3 3 2\n1 1 1\n");
+    CHECK(throws([&]() { MatrixMarket::loadCSR(path, pool); }));
+    std::remove(path.c_str());
+  }
+}
+
+int main() {
+  ThreadPool pool(4);
+  std::mt19937 random(458);
+  std::uniform_int_distribution<int> row(0, 299), col(0, 199);
+  std::uniform_real_distribution<double> value(-10, 10);
+
+  Triplets entries;
+  for (int k = 0; k < 20000; k++) {
+    entries.emplace_back(row(random), col(random), value(random));
+  }
+  const SparseMatrixCSR A = SparseMatrixCSR::fromTriplets(300, 200, entries);
+
+  binaryRoundTrips(A);
+  corruptBinaryFiles();
+  matrixMarketRoundTrips(A, pool);
+  matrixMarketLines(pool);
+
+  return testResult();
+}
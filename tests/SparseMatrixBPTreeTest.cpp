@@ -0,0 +1,119 @@
+#include <iterator>
+#include <map>
+#include <random>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "Check.h"
+#include "data_structures/sparse_matrix_bptree/SparseMatrixBPTree.h"
+
+// Compara a árvore B+ com um std::map em centenas de milhares de escritas e remoções aleatórias, o
+// bastante para dividir folhas e nós internos, e confere linhas, soma, multiplicação por escalar e transposta
+
+namespace {
+  using Oracle = std::map<std::pair<int, int>, double>;
+
+  void checkSame(const SparseMatrixBPTree &A, const Oracle &oracle) {
+    CHECK(A.nnz() == oracle.size());
+    const std::vector<std::tuple<int, int, double> > items = A.items();
+    CHECK(items.size() == oracle.size());
+    auto expected = oracle.begin();
+    for (const auto &[i, j, value]: items) {
+      if (expected == oracle.end()) {
+        break;
+      }
+      CHECK(i == expected->first.first && j == expected->first.second && value == expected->second);
+      ++expected;
+    }
+  }
+
+  void checkRows(const SparseMatrixBPTree &A, const Oracle &oracle) {
+    for (int i = 0; i < A.rows(); i++) {
+      std::vector<std::pair<int, double> > expected;
+      for (auto it = oracle.lower_bound({i, 0}); it != oracle.end() && it->first.first == i; ++it) {
+        expected.emplace_back(it->first.second, it->second);
+      }
+      CHECK(A.row(i) == expected);
+    }
+  }
+}
+
+int main() {
+  const int n = 700, m = 500;
+  std::mt19937 random(458);
+  std::uniform_int_distribution<int> row(0, n - 1), col(0, m - 1), value(-4, 4);
+
+  SparseMatrixBPTree A(n, m);
+  Oracle oracle;
+  for (int step = 1; step <= 400000; step++) {
+    const int i = row(random), j = col(random);
+    // Um quarto das escritas é zero, ou seja, remoção
+    const double v = random() % 4 == 0 ? 0.0 : value(random);
+    A.set(i, j, v);
+    if (v == 0.0) {
+      oracle.erase({i, j});
+    } else {
+      oracle[{i, j}] = v;
+    }
+
+    const int qi = row(random), qj = col(random);
+    const auto found = oracle.find({qi, qj});
+    CHECK(A.get(qi, qj) == (found == oracle.end() ? 0.0 : found->second));
+    if (step % 100000 == 0) {
+      checkSame(A, oracle);
+    }
+  }
+  CHECK(A.depth() >= 3);
+  checkRows(A, oracle);
+
+  // Remove quase tudo: folhas esvaziam sem fusão e a árvore continua consistente
+  for (auto it = oracle.begin(); it != oracle.end();) {
+    if (random() % 10 != 0) {
+      A.set(it->first.first, it->first.second, 0.0);
+      it = oracle.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  checkSame(A, oracle);
+  checkRows(A, oracle);
+
+  // Soma com uma matriz que anula parte dos elementos e acrescenta outros, com fator pendente em A
+  Oracle other;
+  for (const auto &[position, v]: oracle) {
+    if (random() % 2 == 0) {
+      other[position] = -2 * v;
+    }
+  }
+  for (int k = 0; k < 20000; k++) {
+    other[{row(random), col(random)}] += value(random) * 3 + 1;
+  }
+  std::vector<std::tuple<int, int, double> > entries;
+  Oracle sum;
+  for (const auto &[position, v]: oracle) {
+    sum[position] += 2 * v;
+  }
+  for (const auto &[position, v]: other) {
+    entries.emplace_back(position.first, position.second, v);
+    sum[position] += v;
+  }
+  for (auto it = sum.begin(); it != sum.end();) {
+    it = it->second == 0.0 ? sum.erase(it) : std::next(it);
+  }
+  const SparseMatrixBPTree B = SparseMatrixBPTree::fromTriplets(n, m, entries);
+  checkSame(A.scalarMult(2).add(B), sum);
+
+  // Transposta, inclusive do fator pendente
+  SparseMatrixBPTree T = A.transpose();
+  T *= 3;
+  CHECK(T.rows() == m && T.cols() == n);
+  Oracle transposed;
+  for (const auto &[position, v]: oracle) {
+    transposed[{position.second, position.first}] = 3 * v;
+  }
+  checkSame(T, transposed);
+  checkRows(T, transposed);
+
+  return testResult();
+}
@@ -0,0 +1,137 @@
+#include <algorithm>
+#include <map>
+#include <random>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "Check.h"
+#include "data_structures/sparse_matrix_tree/SparseMatrixTree.h"
+
+// Confere as invariantes da árvore rubronegra inclinada à esquerda, o conteúdo (contra um std::map) e os nós
+// vivos da arena depois de remoções, de pruneZeros e das somas no lugar, pelos dois caminhos do Merger
+
+namespace {
+  using Tree = SparseMatrixTree;
+  using Oracle = std::map<std::pair<int, int>, double>;
+
+  void checkTree(const Tree::NodeArena &arena, Tree::TreeNode *root, const Oracle &oracle) {
+    CHECK(Tree::checkInvariants(root));
+    CHECK(arena.size() == oracle.size());
+
+    std::vector<std::tuple<int, int, double> > entries;
+    Tree::sortedEntries(root, false, entries);
+    CHECK(entries.size() == oracle.size());
+    auto expected = oracle.begin();
+    for (const auto &[i, j, value]: entries) {
+      if (expected == oracle.end()) {
+        break;
+      }
+      CHECK(i == expected->first.first && j == expected->first.second && value == expected->second);
+      ++expected;
+    }
+  }
+
+  /// @brief Soma B (guardada como a transposta, se transposeB) em A no lugar, consumindo B, e confere
+  void checkConsumingAdd(std::mt19937 &random, Tree::NodeArena &arena, Tree::TreeNode *&root, Oracle &oracle,
+                         const int n, const int elements, const bool transposeB) {
+    std::uniform_int_distribution<int> position(0, n - 1), value(-3, 3);
+    Oracle other;
+    // Metade de B anula elementos de A
+    for (const auto &[key, v]: oracle) {
+      if (static_cast<int>(other.size()) >= elements / 2) {
+        break;
+      }
+      if (random() % 3 == 0) {
+        other[key] = -v;
+      }
+    }
+    while (static_cast<int>(other.size()) < elements) {
+      other[{position(random), position(random)}] = value(random) * 2 + 1;
+    }
+
+    std::vector<std::tuple<int, int, double> > entries;
+    for (const auto &[key, v]: other) {
+      entries.emplace_back(transposeB ? key.second : key.first, transposeB ? key.first : key.second, v);
+      if ((oracle[key] += v) == 0.0) {
+        oracle.erase(key);
+      }
+    }
+    Tree::TreeNode *rootB = Tree::buildFromUnsorted(arena, entries);
+    root = Tree::addInPlaceConsuming(arena, root, rootB, false, transposeB);
+    checkTree(arena, root, oracle);
+  }
+}
+
+int main() {
+  const int n = 400;
+  std::mt19937 random(458);
+  std::uniform_int_distribution<int> position(0, n - 1), value(-4, 4);
+
+  // Escritas e remoções aleatórias
+  Tree::NodeArena arena;
+  Tree::TreeNode *root = nullptr;
+  Oracle oracle;
+  for (int step = 1; step <= 200000; step++) {
+    const int i = position(random), j = position(random);
+    const double v = random() % 3 == 0 ? 0.0 : value(random);
+    root = Tree::set(arena, root, i, j, v);
+    if (v == 0.0) {
+      oracle.erase({i, j});
+    } else {
+      oracle[{i, j}] = v;
+    }
+    if (step % 20000 == 0) {
+      checkTree(arena, root, oracle);
+    }
+  }
+
+  // Remoção de tudo, em ordem aleatória, até a árvore vazia
+  {
+    std::vector<std::pair<int, int> > keys;
+    for (const auto &[key, v]: oracle) {
+      keys.push_back(key);
+    }
+    std::shuffle(keys.begin(), keys.end(), random);
+    Oracle remaining = oracle;
+    for (size_t k = 0; k < keys.size(); k++) {
+      root = Tree::erase(arena, root, keys[k].first, keys[k].second);
+      remaining.erase(keys[k]);
+      if (k % 5000 == 0) {
+        checkTree(arena, root, remaining);
+      }
+    }
+    CHECK(root == nullptr);
+    checkTree(arena, root, remaining);
+  }
+
+  // pruneZeros depois de zerar um terço dos nós por escrita direta
+  std::vector<std::tuple<int, int, double> > entries;
+  oracle.clear();
+  for (int k = 0; k < 60000; k++) {
+    const int i = position(random), j = position(random);
+    const double v = value(random) * 2 + 1;
+    entries.emplace_back(i, j, v);
+    oracle[{i, j}] = v;
+  }
+  root = Tree::buildFromUnsorted(arena, entries);
+  checkTree(arena, root, oracle);
+  std::vector<Tree::TreeNode *> nodes;
+  Tree::inorderGet(root, false, nodes);
+  for (Tree::TreeNode *node: nodes) {
+    if (random() % 3 == 0) {
+      node->value = 0.0;
+      oracle.erase({node->row, node->column});
+    }
+  }
+  root = Tree::pruneZeros(arena, root);
+  checkTree(arena, root, oracle);
+
+  // Somas no lugar: B pequena (buscas individuais em A) e B grande (mescla das listas), normal e transposta
+  checkConsumingAdd(random, arena, root, oracle, n, 200, false);
+  checkConsumingAdd(random, arena, root, oracle, n, 300, true);
+  checkConsumingAdd(random, arena, root, oracle, n, 40000, false);
+  checkConsumingAdd(random, arena, root, oracle, n, 40000, true);
+
+  return testResult();
+}